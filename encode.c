@@ -0,0 +1,280 @@
+/******************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ))
+#define E_encode_J_x86 1
+#include <immintrin.h>
+#endif
+#include "encode.h"
+//==============================================================================
+#define E_encode_J_58_4     ( 58 * 58 * 58 * 58 )
+//==============================================================================
+const char E_encode_S_base64url[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char E_encode_S_base32[32] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+const char E_encode_S_base32_crockford[32] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+const char E_encode_S_base58[58] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+//==============================================================================
+/*
+ * The encoders take whole groups of random bytes: 3 bytes give 4 base64url
+ * characters, 5 bytes give 8 base32 characters. The bit order is the one of
+ * RFC 4648, so every SIMD path gives the same output as the scalar one.
+ */
+static
+void
+E_encode_I_base64url_I_scalar( char *dst
+, const unsigned char *src
+, size_t groups
+){  while( groups-- )
+    {   unsigned d = (unsigned)src[0] << 16 | (unsigned)src[1] << 8 | src[2];
+        dst[0] = E_encode_S_base64url[ d >> 18 ];
+        dst[1] = E_encode_S_base64url[ ( d >> 12 ) & 0x3f ];
+        dst[2] = E_encode_S_base64url[ ( d >> 6 ) & 0x3f ];
+        dst[3] = E_encode_S_base64url[ d & 0x3f ];
+        src += 3;
+        dst += 4;
+    }
+}
+static
+void
+E_encode_I_base32_I_scalar( char *dst
+, const unsigned char *src
+, size_t groups
+, const char *alphabet
+){  while( groups-- )
+    {   uint64_t d = 0;
+        for( unsigned i = 0; i != 5; i++ )
+            d = d << 8 | src[i];
+        for( unsigned i = 0; i != 8; i++ )
+            dst[i] = alphabet[ ( d >> ( 35 - i * 5 )) & 0x1f ];
+        src += 5;
+        dst += 8;
+    }
+}
+#ifdef E_encode_J_x86
+/*
+ * Unpacking of 12 bytes into 16 sextets and the sextet to ASCII translation
+ * by range offsets follow Wojciech Muła's base64 encoder.
+ */
+__attribute__(( target( "ssse3" )))
+static
+__m128i
+E_encode_I_base64url_I_ssse3_I_chars( __m128i in
+){  in = _mm_shuffle_epi8( in, _mm_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1 ));
+    __m128i hi = _mm_mulhi_epu16( _mm_and_si128( in, _mm_set1_epi32( 0x0fc0fc00 )), _mm_set1_epi32( 0x04000040 ));
+    __m128i lo = _mm_mullo_epi16( _mm_and_si128( in, _mm_set1_epi32( 0x003f03f0 )), _mm_set1_epi32( 0x01000010 ));
+    __m128i indices = _mm_or_si128( hi, lo );
+    // 0..25 → 13, 26..51 → 0, 52..61 → 1..10, 62 → 11, 63 → 12.
+    __m128i range = _mm_subs_epu8( indices, _mm_set1_epi8( 51 ));
+    range = _mm_or_si128( range, _mm_and_si128( _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), indices ), _mm_set1_epi8( 13 )));
+    __m128i offset = _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52
+    , '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62
+    , '_' - 63, 'A', 0, 0
+    );
+    return _mm_add_epi8( _mm_shuffle_epi8( offset, range ), indices );
+}
+__attribute__(( target( "ssse3" )))
+static
+size_t
+E_encode_I_base64url_I_ssse3( char *dst
+, const unsigned char *src
+, size_t groups
+){  size_t i = 0;
+    for( ; ( i + 4 ) * 3 + 4 <= groups * 3; i += 4 ) // Ładuje 16 bajtów, używa 12.
+        _mm_storeu_si128(( __m128i * )( dst + i * 4 ), E_encode_I_base64url_I_ssse3_I_chars( _mm_loadu_si128(( const __m128i * )( src + i * 3 ))));
+    return i;
+}
+__attribute__(( target( "avx2" )))
+static
+size_t
+E_encode_I_base64url_I_avx2( char *dst
+, const unsigned char *src
+, size_t groups
+){  size_t i = 0;
+    for( ; ( i + 8 ) * 3 + 4 <= groups * 3; i += 8 )
+    {   __m256i in = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128(( const __m128i * )( src + i * 3 )))
+        , _mm_loadu_si128(( const __m128i * )( src + i * 3 + 12 ))
+        , 1
+        );
+        in = _mm256_shuffle_epi8( in, _mm256_set_epi8( 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1
+        , 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1
+        ));
+        __m256i hi = _mm256_mulhi_epu16( _mm256_and_si256( in, _mm256_set1_epi32( 0x0fc0fc00 )), _mm256_set1_epi32( 0x04000040 ));
+        __m256i lo = _mm256_mullo_epi16( _mm256_and_si256( in, _mm256_set1_epi32( 0x003f03f0 )), _mm256_set1_epi32( 0x01000010 ));
+        __m256i indices = _mm256_or_si256( hi, lo );
+        __m256i range = _mm256_subs_epu8( indices, _mm256_set1_epi8( 51 ));
+        range = _mm256_or_si256( range, _mm256_and_si256( _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), indices ), _mm256_set1_epi8( 13 )));
+        __m256i offset = _mm256_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52
+        , '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62
+        , '_' - 63, 'A', 0, 0
+        , 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52
+        , '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '-' - 62
+        , '_' - 63, 'A', 0, 0
+        );
+        _mm256_storeu_si256(( __m256i * )( dst + i * 4 ), _mm256_add_epi8( _mm256_shuffle_epi8( offset, range ), indices ));
+    }
+    return i;
+}
+/*
+ * Two groups per step: a mask-and-shift ladder spreads each 40 bit group into
+ * 8 bytes of 5 bits (PDEP would, but it is microcoded on AMD before Zen 3),
+ * then two PSHUFB lookups (for indices 0..15 and 16..31) translate them.
+ */
+__attribute__(( target( "ssse3" )))
+static
+size_t
+E_encode_I_base32_I_ssse3( char *dst
+, const unsigned char *src
+, size_t groups
+, const char *alphabet
+){  __m128i table_lo = _mm_loadu_si128(( const __m128i * )alphabet );
+    __m128i table_hi = _mm_loadu_si128(( const __m128i * )( alphabet + 16 ));
+    size_t i = 0;
+    for( ; ( i + 2 ) * 5 + 3 <= groups * 5; i += 2 ) // Ładuje 8 bajtów na grupę, używa 5.
+    {   uint64_t d[2];
+        for( unsigned j = 0; j != 2; j++ )
+        {   uint64_t v;
+            memcpy( &v, src + ( i + j ) * 5, sizeof(v) );
+            v = __builtin_bswap64(v) >> 24;
+            v = ( v & 0x00000000000fffffULL ) | ( v & 0x000000fffff00000ULL ) << 12;
+            v = ( v & 0x000003ff000003ffULL ) | ( v & 0x000ffc00000ffc00ULL ) << 6;
+            v = ( v & 0x001f001f001f001fULL ) | ( v & 0x03e003e003e003e0ULL ) << 3;
+            d[j] = __builtin_bswap64(v);
+        }
+        __m128i indices = _mm_set_epi64x( d[1], d[0] );
+        __m128i hi = _mm_cmpgt_epi8( indices, _mm_set1_epi8( 15 ));
+        __m128i chars = _mm_or_si128( _mm_andnot_si128( hi, _mm_shuffle_epi8( table_lo, indices ))
+        , _mm_and_si128( hi, _mm_shuffle_epi8( table_hi, indices ))
+        );
+        _mm_storeu_si128(( __m128i * )( dst + i * 8 ), chars );
+    }
+    return i;
+}
+#endif
+/*
+ * Binary and octal digits: every byte of random bits is spread to one byte
+ * per digit (bit i to byte i for binary, 3 bits at a time for 24 bit octal
+ * groups) by a mask-and-shift ladder and ORed with '0'. PDEP would do the
+ * same in one instruction, but it is microcoded and much slower on AMD
+ * before Zen 3, and the ladder is close to it elsewhere.
+ */
+static
+void
+E_encode_I_store( char *dst
+, uint64_t v
+){
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+    #endif
+    memcpy( dst, &v, sizeof(v) );
+}
+static
+void
+E_encode_I_binary_I_scalar( char *dst
+, const unsigned char *src
+, size_t n
+){  while( n-- )
+    {   uint64_t v = *src++;
+        v = ( v | v << 28 ) & 0x0000000f0000000fULL;
+        v = ( v | v << 14 ) & 0x0003000300030003ULL;
+        v = ( v | v << 7 ) & 0x0101010101010101ULL;
+        E_encode_I_store( dst, v | 0x3030303030303030ULL );
+        dst += 8;
+    }
+}
+static
+void
+E_encode_I_octal_I_scalar( char *dst
+, const unsigned char *src
+, size_t groups
+){  while( groups-- )
+    {   uint64_t v = (uint64_t)src[0] | (uint64_t)src[1] << 8 | (uint64_t)src[2] << 16;
+        v = ( v | v << 20 ) & 0x00000fff00000fffULL;
+        v = ( v | v << 10 ) & 0x003f003f003f003fULL;
+        v = ( v | v << 5 ) & 0x0707070707070707ULL;
+        E_encode_I_store( dst, v | 0x3030303030303030ULL );
+        src += 3;
+        dst += 8;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void
+E_encode_I_hex( char *dst
+, const unsigned char *src
+, size_t n
+, const char *digits
+){  while( n-- )
+    {   dst[0] = digits[ *src >> 4 ];
+        dst[1] = digits[ *src++ & 0xf ];
+        dst += 2;
+    }
+}
+void
+E_encode_I_binary( char *dst
+, const unsigned char *src
+, size_t n
+){  E_encode_I_binary_I_scalar( dst, src, n );
+}
+void
+E_encode_I_octal( char *dst
+, const unsigned char *src
+, size_t groups
+){  E_encode_I_octal_I_scalar( dst, src, groups );
+}
+void
+E_encode_I_base64url( char *dst
+, const unsigned char *src
+, size_t groups
+){  size_t i = 0;
+    #ifdef E_encode_J_x86
+    if( __builtin_cpu_supports( "avx2" ))
+        i = E_encode_I_base64url_I_avx2( dst, src, groups );
+    else if( __builtin_cpu_supports( "ssse3" ))
+        i = E_encode_I_base64url_I_ssse3( dst, src, groups );
+    #endif
+    E_encode_I_base64url_I_scalar( dst + i * 4, src + i * 3, groups - i );
+}
+void
+E_encode_I_base32( char *dst
+, const unsigned char *src
+, size_t groups
+, const char *alphabet
+){  size_t i = 0;
+    #ifdef E_encode_J_x86
+    if( __builtin_cpu_supports( "ssse3" ))
+        i = E_encode_I_base32_I_ssse3( dst, src, groups, alphabet );
+    #endif
+    E_encode_I_base32_I_scalar( dst + i * 8, src + i * 5, groups - i, alphabet );
+}
+/*
+ * Three decimal digits of a number below 1000, dividing by multiplication
+ * (exact for this range).
+ */
+void
+E_encode_I_decimal3( char *dst
+, unsigned v
+){  unsigned d = ( v * 41 ) >> 12;
+    v -= d * 100;
+    unsigned e = ( v * 103 ) >> 10;
+    dst[0] = '0' + d;
+    dst[1] = '0' + e;
+    dst[2] = '0' + v - e * 10;
+}
+/*
+ * Converts a number below 58^n (n ≤ 8) to n base58 digits: the value is split
+ * at 58^4, so all the divisions are by constants on 32 bit halves.
+ */
+void
+E_encode_I_base58( char *dst
+, uint64_t v
+, unsigned n
+){  uint32_t d = v % E_encode_J_58_4;
+    uint32_t e = v / E_encode_J_58_4;
+    for( unsigned i = 0; i != n; i++ )
+    {   if( i == 4 )
+            d = e;
+        dst[ n - 1 - i ] = E_encode_S_base58[ d % 58 ];
+        d /= 58;
+    }
+}
+/******************************************************************************/
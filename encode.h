@@ -0,0 +1,16 @@
+#ifndef ENCODE_H
+#define ENCODE_H
+#include <stddef.h>
+#include <stdint.h>
+extern const char E_encode_S_base64url[64];
+extern const char E_encode_S_base32[32];
+extern const char E_encode_S_base32_crockford[32];
+extern const char E_encode_S_base58[58];
+void E_encode_I_hex( char *, const unsigned char *, size_t, const char * );
+void E_encode_I_binary( char *, const unsigned char *, size_t );
+void E_encode_I_octal( char *, const unsigned char *, size_t );
+void E_encode_I_decimal3( char *, unsigned );
+void E_encode_I_base64url( char *, const unsigned char *, size_t );
+void E_encode_I_base32( char *, const unsigned char *, size_t, const char * );
+void E_encode_I_base58( char *, uint64_t, unsigned );
+#endif
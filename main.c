@@ -9,16 +9,28 @@
  *   (at your option) any later version; incorporated herein by reference.
  *
  * ----------------------------------------------------------------------- */
+#define _GNU_SOURCE                 /* fopencookie where HAVE_FOPENCOOKIE */
 #include "config.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
 #ifdef HAVE_GETOPT_H
 #include <getopt.h>
 #endif
+#include "encode.h"
 #include "main.h"
+#include "pattern.h"
+#include "permute.h"
 #include "random.h"
 //==============================================================================
 enum output_type {
@@ -30,20 +42,110 @@ enum output_type {
   ty_ip,
   ty_mac, ty_umac,
   ty_uuid, ty_uuuid,
-  ty_dec, ty_oct, ty_binary
+  ty_dec, ty_oct, ty_binary,
+  ty_base64url, ty_base32, ty_base32c, ty_base58,
+  ty_pattern
 };
 enum extended_options {
   OPT_UPPER = 256,
   OPT_LOWER,
   OPT_ASCII,
+  OPT_UUID_VERSION,
+  OPT_BASE64URL,
+  OPT_BASE32,
+  OPT_BASE32C,
+  OPT_BASE58,
+  OPT_KEY,
+  OPT_SHARD,
+  OPT_BATCH,
+  OPT_STATS,
+  OPT_HARDWARE,
+  OPT_PATTERN,
+  OPT_NO_REPEAT,
+  OPT_NO_SEQUENCE,
+  OPT_NO_AMBIGUOUS,
 };
 struct E_main_Z_min_max
 { unsigned min, max;
 };
+struct E_main_Z_spec
+{ enum output_type type;
+  uint64_t elements;
+  int decor;
+  _Bool length_in_bits, enumerate;
+  uint64_t prefix;
+  unsigned prefix_bits;
+  uint64_t count;
+  uint64_t first, last;             /* Items to output */
+  struct E_pattern_Z *pattern;
+  unsigned filter;                  /* E_pattern_J_no_* */
+};
+/* State of the filters while an item is output */
+struct E_main_Z_filter
+{ unsigned flags;                   /* E_pattern_J_no_* */
+  unsigned chars_n, bits;
+  unsigned redraw_bits;             /* Twice the bits expected for redraws per 1024 characters */
+  _Bool direct;                     /* Drawn from "chars" rather than encoded and redrawn */
+  char chars[256];                  /* The alphabet without the ambiguous characters */
+  unsigned char banned[257];        /* After "prev" (index prev + 1): bit 0 if "prev" is rejected, bit 1 if "prev" + 1 */
+  int prev;                         /* Previous character of the item, -1 at its start */
+  uint64_t resampled;
+};
+struct E_main_Z_batch
+{ struct E_main_Z_spec spec;
+  char *label;
+  char *out;                        /* Labelled output waiting for its turn */
+  size_t out_n, out_size;
+  int ret;
+  _Bool done, midline;
+};
 //==============================================================================
 extern _Bool E_random_S_secure_source;
+extern _Bool E_random_S_hardware_source;
+extern _Bool E_random_S_keyed;
+extern atomic_ullong E_random_S_stats_bytes, E_random_S_stats_refills, E_random_S_stats_hardware_failures;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 const char *E_main_S_program;
+static unsigned E_main_S_uuid_version = 4;
+static _Thread_local FILE *E_main_S_out;
+static unsigned E_main_S_filter;         /* E_pattern_J_no_* */
+static atomic_ullong E_main_S_stats_chars, E_main_S_stats_resampled;
+static struct E_main_Z_batch *E_main_S_batch;
+static size_t E_main_S_batch_n, E_main_S_batch_next;
+static size_t E_main_S_batch_head;      /* The job writing straight to stdout */
+static pthread_mutex_t E_main_S_batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t E_main_S_batch_cond = PTHREAD_COND_INITIALIZER;
+static const struct
+{ const char *name;
+  enum output_type type;
+  int elements;
+} E_main_S_batch_types[] = {
+  { "hard",             ty_hard,        12 },
+  { "ascii",            ty_ascii,       12 },
+  { "lc-ascii",         ty_lascii,      12 },
+  { "uc-ascii",         ty_uascii,      12 },
+  { "alphanum",         ty_anum,        12 },
+  { "lc-alphanum",      ty_lcase,       12 },
+  { "uc-alphanum",      ty_ucase,       12 },
+  { "alpha",            ty_alpha,       12 },
+  { "lc-alpha",         ty_alcase,      12 },
+  { "uc-alpha",         ty_aucase,      12 },
+  { "hexadecimal",      ty_hex,         12 },
+  { "uc-hexadecimal",   ty_uhex,        12 },
+  { "decimal",          ty_dec,         12 },
+  { "octal",            ty_oct,         12 },
+  { "binary",           ty_binary,      12 },
+  { "ip",               ty_ip,          4 },
+  { "mac-address",      ty_mac,         6 },
+  { "uc-mac-address",   ty_umac,        6 },
+  { "uuid",             ty_uuid,        12 },
+  { "uc-uuid",          ty_uuuid,       12 },
+  { "base64url",        ty_base64url,   12 },
+  { "base32",           ty_base32,      12 },
+  { "base32-crockford", ty_base32c,     12 },
+  { "base58",           ty_base58,      12 },
+  { "pattern",          ty_pattern,     0 },
+};
 static const char *short_options = "raluxXdobALUimgGMschV";
 #ifdef HAVE_GETOPT_LONG
 const struct option long_options[] = {
@@ -67,7 +169,21 @@ const struct option long_options[] = {
   { "uuid",         0, 0, 'g' },
   { "uc-guid",      0, 0, 'G' },
   { "uc-uuid",      0, 0, 'G' },
+  { "uuid-version", 1, 0, OPT_UUID_VERSION },
+  { "base64url",    0, 0, OPT_BASE64URL },
+  { "base32",       0, 0, OPT_BASE32 },
+  { "base32-crockford", 0, 0, OPT_BASE32C },
+  { "base58",       0, 0, OPT_BASE58 },
+  { "pattern",      1, 0, OPT_PATTERN },
+  { "no-repeat",    0, 0, OPT_NO_REPEAT },
+  { "no-sequence",  0, 0, OPT_NO_SEQUENCE },
+  { "no-ambiguous", 0, 0, OPT_NO_AMBIGUOUS },
   { "secure",       0, 0, 's' },
+  { "hardware",     0, 0, OPT_HARDWARE },
+  { "key",          1, 0, OPT_KEY },
+  { "shard",        1, 0, OPT_SHARD },
+  { "batch",        1, 0, OPT_BATCH },
+  { "stats",        0, 0, OPT_STATS },
   { "c",		    0, 0, 'c' },
   { "help",         0, 0, 'h' },
   { "version",      0, 0, 'V' },
@@ -83,7 +199,7 @@ static void usage(int err)
 {
   fprintf(stderr,
 	  "%s %s\n"
-	  "Usage: %s [options] [length [count]]\n"
+	  "Usage: %s [options] [length[b] [count]]\n"
 	  LO("  --hard               " "  -r  Hard password\n")
 	  LO("  --ascii              " "      Any ASCII characters\n")
 	  LO("  --alphanum           ")"  -a  Alphanumeric\n"
@@ -103,9 +219,27 @@ static void usage(int err)
 	  LO("  --mac-address --upper")"  -M  Upper case Ethernet MAC address\n"
 	  LO("  --uuid               ")"  -g  UUID/GUID\n"
 	  LO("  --uuid --upper       ")"  -G  Upper case UUID/GUID\n"
+	  LO("  --uuid-version 4|7   ""      UUID version: random or time-ordered\n")
+	  LO("  --base64url          ""      Base64 with URL and file name safe alphabet\n")
+	  LO("  --base32             ""      Base32\n")
+	  LO("  --base32-crockford   ""      Crockford's Base32\n")
+	  LO("  --base58             ""      Base58 (Bitcoin alphabet)\n")
+	  LO("  --pattern PATTERN    ""      Layout like XXXX-9999 or [A-Z]{3}-h{8} (see ranpwd(1))\n")
+	  LO("  --no-repeat          ""      No character twice in a row\n")
+	  LO("  --no-sequence        ""      No letter or digit right after its predecessor (ab, 12)\n")
+	  LO("  --no-ambiguous       ""      Without the look-alike glyphs B8G6I1l0OQDS5Z2\n")
 	  LO("  --secure             ")"  -s  Slower but more secure\n"
+	  LO("  --hardware           ""      Key the generator with RDRAND/RDSEED where available\n")
+	  LO("  --key HEX            ""      Generate item k from a 256 bit key and k only\n")
+	  LO("  --shard I/N          ""      Output only the I-th of N slices (needs --key)\n")
+	  LO("  --batch FILE|-       ""      Run the specs \"TYPE [LENGTH [COUNT [c|- [LABEL]]]]\"\n"
+	     "                             of the lines of FILE; output is \"LABEL<tab>item\"\n")
+	  LO("  --stats              ""      Report the random source and its use on stderr\n")
 	  LO("  --help               ")"  -h  Show this message\n"
 	  LO("  --version            ")"  -V  Display E_main_S_program version\n"
+	  "A length with a \"b\" suffix is given in bits of entropy.\n"
+	  "For IP and MAC addresses a prefix (10.20.0.0/16, 02:1a:2b) may be given instead\n"
+	  "of the length to output count distinct addresses within it.\n"
 	  , PACKAGE_NAME, PACKAGE_VERSION, E_main_S_program);
   exit(err);
 }
@@ -113,7 +247,7 @@ static void usage(int err)
 /*
  * cputc():
  *
- * putchar(), with option to escape characters that have to be escaped in C
+ * putc() to the output, with option to escape characters that have to be escaped in C
  */
 static
 void
@@ -124,9 +258,9 @@ cputc( int c
         { case '\"':
           case '\\':
           case '\'':
-            putchar('\\');
+            putc( '\\', E_main_S_out );
         }
-    putchar(c);
+    putc( c, E_main_S_out );
 }
 static
 int
@@ -135,55 +269,616 @@ bits_in_count( unsigned count
 }
 static
 unsigned
-E_main_I_print_I_ranges_I_bits(
+bits_in_count64( uint64_t count
+){  return count == 1 ? 0 : sizeof(uint64_t) * 8 - __builtin_clzll( count - 1 );
+}
+/* Up to 64 prepared bits */
+static
+uint64_t
+E_main_R_bits64( unsigned bits
+){  if( !bits )
+        return 0;
+    return bits > 32
+    ? E_random_R_bits(32) | (uint64_t)E_random_R_bits( bits - 32 ) << 32
+    : E_random_R_bits(bits);
+}
+/*
+ * The filters run as a second pass over characters already encoded in bulk:
+ * one rejected after the previous one is drawn again from the alphabet, for
+ * its position only, so a kept character is uniform over those allowed after
+ * its predecessor.  Without the ambiguous characters the alphabet is drawn
+ * from directly instead (see E_main_I_print), as encoding the whole of it
+ * would mean a redraw for every one of them.
+ */
+#define E_main_J_filter_reject(filter,c,prev) \
+    ( ( (unsigned)( (c) - (prev) ) <= 1 ) \
+    & (filter)->banned[ (prev) + 1 ] >> ( ( (c) - (prev) ) & 1 ))  /* Without a branch to mispredict */
+static
+int
+E_main_I_filter( struct E_main_Z_filter *filter
+, char *s
+, size_t n
+){  int prev = filter->prev;
+    /* Reserve twice the bits expected for the redraws up front, or each one
+     * would refill the drained pool on its own. */
+    if( E_random_I_prepare_data( n * filter->redraw_bits / 1024 + filter->bits ))
+        return ~0;
+    for( size_t i = 0; i != n; i++ )
+    {   int c = (unsigned char)s[i];
+        if( E_main_J_filter_reject( filter, c, prev ))
+        {   do
+            {   unsigned v;
+                do
+                {   if( E_random_I_prepare_data( filter->bits ))
+                        return ~0;
+                    v = E_random_R_bits( filter->bits );
+                }while( v >= filter->chars_n );
+                c = (unsigned char)filter->chars[v];
+                filter->resampled++;
+            }while( E_main_J_filter_reject( filter, c, prev ));
+            s[i] = c;
+        }
+        prev = c;
+    }
+    filter->prev = prev;
+    return 0;
+}
+static
+unsigned
+E_main_I_print_I_ranges_I_count(
   unsigned ranges_n
 , struct E_main_Z_min_max ranges[]
 ){  unsigned count = 0;
     for( unsigned i = 0; i != ranges_n; i++ )
         count += ranges[i].max - ranges[i].min + 1;
-    return bits_in_count(count);
+    return count;
 }
+/*
+ * Draws a character of the ranges.  A value past the count of the characters
+ * is drawn again rather than wrapped around, so that every character is
+ * equally likely and a length in bits gets log2(count) bits per character.
+ */
 static
-unsigned
-E_main_I_print_I_ranges_I_chars( unsigned c
+int
+E_main_I_print_I_ranges_I_draw( unsigned *c
 , unsigned ranges_n
 , struct E_main_Z_min_max ranges[]
-){  unsigned i = 0;
+){  unsigned count = E_main_I_print_I_ranges_I_count( ranges_n, ranges );
+    unsigned bits = bits_in_count(count);
+    unsigned v;
     do
-    {   c += ranges[i].min;
-        if( c <= ranges[i].max )
-            break;
-        c -= ranges[i].max + 1;
-        if( i != ranges_n - 1 )
-            i++;
-        else
-            i = 0;
-    }while(true);
-    return c;
+    {   if( E_random_I_prepare_data(bits))
+            return ~0;
+        v = E_random_R_bits(bits);
+    }while( v >= count );
+    unsigned i = 0;
+    while( v > ranges[i].max - ranges[i].min )
+    {   v -= ranges[i].max - ranges[i].min + 1;
+        i++;
+    }
+    *c = ranges[i].min + v;
+    return 0;
 }
+/*
+ * Every output type draws from the pool at most a chunk of characters at a
+ * time, so memory use does not depend on the length and output starts at once.
+ */
+#define E_main_J_ranges_chunk   4096
 static
 int
-E_main_I_print_I_ranges( enum output_type type
-, int n
+E_main_I_print_I_ranges( uint64_t n
 , int decor
 , unsigned ranges_n
 , struct E_main_Z_min_max ranges[]
-){  unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-    if( E_random_I_prepare_data( n * bits ))
-        return ~0;
+, struct E_main_Z_filter *filter
+){  char table[256];
+    const char *chars = table;
+    unsigned count = 0;
+    if(filter)  /* Already without the ambiguous characters */
+    {   chars = filter->chars;
+        count = filter->chars_n;
+    }else
+        for( unsigned i = 0; i != ranges_n; i++ )
+            for( unsigned c = ranges[i].min; c <= ranges[i].max; c++ )
+                table[ count++ ] = c;
+    unsigned bits = bits_in_count(count);
+    unsigned mean_bits = ( bits << bits ) / count + 1;
+    char buf[ E_main_J_ranges_chunk ];
+    while(n)
+    {   unsigned chunk = J_min( n, E_main_J_ranges_chunk );
+        if( E_random_I_prepare_data( chunk * mean_bits ))
+            return ~0;
+        n -= chunk;
+        for( unsigned i = 0; i != chunk; i++ )
+        {   unsigned v;
+            do
+            {   if( E_random_I_prepare_data(bits))
+                    return ~0;
+                v = E_random_R_bits(bits);
+            }while( v >= count );
+            buf[i] = chars[v];
+        }
+        if( filter
+        && E_main_I_filter( filter, buf, chunk )
+        )
+            return ~0;
+        if(decor)
+            for( unsigned i = 0; i != chunk; i++ )
+                cputc( (unsigned char)buf[i], decor );
+        else
+            fwrite( buf, 1, chunk, E_main_S_out );
+    }
+    return 0;
+}
+/*
+ * Power-of-two alphabets (binary, octal, hexadecimal, base32, base64url): whole groups of
+ * random bytes are taken from the pool and encoded in bulk, the last partial
+ * group takes exactly the bits of the remaining characters.
+ */
+#define E_main_J_radix_chunk    512
+static
+int
+E_main_I_print_I_radix( uint64_t n
+, unsigned bits
+, const char *alphabet
+, struct E_main_Z_filter *filter
+){  unsigned group_chars = bits == 6 ? 4 : 8;
+    unsigned group_bytes = bits * group_chars / 8;
+    uint64_t groups = n / group_chars;
+    unsigned char data[ E_main_J_radix_chunk * 5 ];
+    char buf[ E_main_J_radix_chunk * 8 ];
+    while(groups)
+    {   unsigned chunk = J_min( groups, E_main_J_radix_chunk );
+        if( E_random_I_prepare_data( chunk * group_bytes * 8 ))
+            return ~0;
+        E_random_R_data( data, chunk * group_bytes );
+        switch(bits)
+        { case 1:
+                E_encode_I_binary( buf, data, chunk );
+                break;
+          case 3:
+                E_encode_I_octal( buf, data, chunk );
+                break;
+          case 4:
+                E_encode_I_hex( buf, data, chunk * group_bytes, alphabet );
+                break;
+          case 5:
+                E_encode_I_base32( buf, data, chunk, alphabet );
+                break;
+          case 6:
+                E_encode_I_base64url( buf, data, chunk );
+                break;
+        }
+        if( filter
+        && E_main_I_filter( filter, buf, chunk * group_chars )
+        )
+            return ~0;
+        fwrite( buf, 1, chunk * group_chars, E_main_S_out );
+        groups -= chunk;
+    }
+    n %= group_chars;
+    if(n)
+    {   if( E_random_I_prepare_data( n * bits ))
+            return ~0;
+        for( unsigned i = 0; i != n; i++ )
+            buf[i] = alphabet[ E_random_R_bits(bits) ];
+        if( filter
+        && E_main_I_filter( filter, buf, n )
+        )
+            return ~0;
+        fwrite( buf, 1, n, E_main_S_out );
+    }
+    return 0;
+}
+/*
+ * Decimal digits three at a time from 10 bit draws below 1000 (97.7% are
+ * accepted), about 1.02 random bits per bit of entropy and unbiased.
+ */
+#define E_main_J_decimal_chunk  1024
+static
+int
+E_main_I_print_I_decimal( uint64_t n
+, struct E_main_Z_filter *filter
+){  char buf[ E_main_J_decimal_chunk * 3 ];
+    uint64_t triplets = n / 3;
+    while(triplets)
+    {   unsigned chunk = J_min( triplets, E_main_J_decimal_chunk );
+        if( E_random_I_prepare_data( chunk * 10 + chunk / 4 + 64 ))
+            return ~0;
+        for( unsigned i = 0; i != chunk; i++ )
+        {   unsigned v;
+            do
+            {   if( E_random_I_prepare_data(10))
+                    return ~0;
+                v = E_random_R_bits(10);
+            }while( v >= 1000 );
+            E_encode_I_decimal3( buf + i * 3, v );
+        }
+        if( filter
+        && E_main_I_filter( filter, buf, chunk * 3 )
+        )
+            return ~0;
+        fwrite( buf, 1, chunk * 3, E_main_S_out );
+        triplets -= chunk;
+    }
+    n %= 3;
+    if(n)
+    {   unsigned max = n == 1 ? 10 : 100;
+        unsigned bits = n == 1 ? 4 : 7;
+        unsigned v;
+        do
+        {   if( E_random_I_prepare_data(bits))
+                return ~0;
+            v = E_random_R_bits(bits);
+        }while( v >= max );
+        E_encode_I_decimal3( buf, v );
+        if( filter
+        && E_main_I_filter( filter, buf + 3 - n, n )
+        )
+            return ~0;
+        fwrite( buf + 3 - n, 1, n, E_main_S_out );
+    }
+    return 0;
+}
+/*
+ * Base58 by big digits: up to 8 characters at a time from one uniform number
+ * below 58^8 (47 bits, 91% of draws accepted), rejecting the rest unbiased.
+ */
+#define E_main_J_base58_digits  8
+#define E_main_J_base58_chunk   512
+static
+int
+E_main_I_print_I_base58( uint64_t n
+, struct E_main_Z_filter *filter
+){  char buf[ E_main_J_base58_digits ];
+    unsigned chunk = 0;
     do
-    {   unsigned c = E_random_R_bits(bits);
-        c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-        cputc( c, decor );
-    }while( --n );
+    {   if( !chunk )
+        {   chunk = J_min(( n + E_main_J_base58_digits - 1 ) / E_main_J_base58_digits, E_main_J_base58_chunk );
+            if( E_random_I_prepare_data( chunk * 52 ))
+                return ~0;
+        }
+        chunk--;
+        unsigned digits = J_min( n, E_main_J_base58_digits );
+        uint64_t max = 1;
+        for( unsigned i = 0; i != digits; i++ )
+            max *= 58;
+        unsigned bits = sizeof(uint64_t) * 8 - __builtin_clzll( max - 1 );
+        uint64_t v;
+        do
+        {   if( E_random_I_prepare_data(bits))
+                return ~0;
+            v = E_main_R_bits64(bits);
+        }while( v >= max );
+        E_encode_I_base58( buf, v, digits );
+        if( filter
+        && E_main_I_filter( filter, buf, digits )
+        )
+            return ~0;
+        fwrite( buf, 1, digits, E_main_S_out );
+        n -= digits;
+    }while(n);
+    return 0;
+}
+/*
+ * UUIDs are generated in chunks: one pool refill and one clock read per chunk,
+ * formatted into a buffer and written at once.
+ * Version 7 (RFC 9562, section 6.2, method 1) keeps a 42 bit counter in
+ * "rand_a" and the top of "rand_b", seeded randomly on every new millisecond
+ * with the top bit clear, so identifiers stay strictly increasing.
+ */
+#define E_main_J_uuid_chunk     1024
+#define E_main_J_uuid_counter_bits  42
+static
+int
+E_main_I_print_I_uuid( uint64_t first
+, uint64_t n
+, _Bool upper
+, int decor
+){  static _Thread_local uint64_t last_ms, counter;
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char buf[ E_main_J_uuid_chunk * ( 36 + 3 ) ];
+    while(n)
+    {   unsigned chunk = J_min( n, E_main_J_uuid_chunk );
+        uint64_t ms = 0;
+        if( E_main_S_uuid_version == 7 )
+        {   if( E_random_I_prepare_data( chunk * 32 + 2 * ( E_main_J_uuid_counter_bits - 1 )))
+                return ~0;
+            struct timespec ts;
+            clock_gettime( CLOCK_REALTIME, &ts );
+            ms = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+        }else if( !E_random_S_keyed
+        && E_random_I_prepare_data( chunk * 122 )
+        )
+            return ~0;
+        char *s = buf;
+        for( unsigned i = 0; i != chunk; i++ )
+        {   unsigned char uuid[16];
+            if( E_random_S_keyed )
+            {   E_random_I_seek( first++ );
+                if( E_random_I_prepare_data( 122 ))
+                    return ~0;
+            }
+            if( E_main_S_uuid_version == 7 )
+            {   if( ms > last_ms
+                || ++counter >> E_main_J_uuid_counter_bits
+                )
+                {   last_ms = ms > last_ms ? ms : last_ms + 1;
+                    counter = E_random_R_bits(32) | (uint64_t)E_random_R_bits( E_main_J_uuid_counter_bits - 1 - 32 ) << 32;
+                }
+                for( unsigned j = 0; j != 6; j++ )
+                    uuid[j] = last_ms >> ( 40 - j * 8 );
+                uuid[6] = 0x70 | counter >> 38;
+                uuid[7] = counter >> 30;
+                uuid[8] = 0x80 | (( counter >> 24 ) & 0x3f );
+                uuid[9] = counter >> 16;
+                uuid[10] = counter >> 8;
+                uuid[11] = counter;
+                for( unsigned j = 12; j != 16; j++ )
+                    uuid[j] = E_random_R_bits(8);
+            }else
+            {   for( unsigned j = 0; j != 16; j++ )
+                    uuid[j] = j == 6 ? 0x40 | E_random_R_bits(4)
+                    : j == 8 ? 0x80 | E_random_R_bits(6)
+                    : E_random_R_bits(8);
+            }
+            if(decor)
+                *s++ = '\"';
+            for( unsigned j = 0; j != 16; j++ )
+            {   if( j == 4 || j == 6 || j == 8 || j == 10 )
+                    *s++ = '-';
+                *s++ = digits[ uuid[j] >> 4 ];
+                *s++ = digits[ uuid[j] & 0xf ];
+            }
+            if(decor)
+                *s++ = '\"';
+            *s++ = '\n';
+        }
+        fwrite( buf, 1, s - buf, E_main_S_out );
+        n -= chunk;
+    }
+    return 0;
+}
+static
+int
+E_main_I_parse_count( const char *s
+, uint64_t *count
+){  char *end;
+    errno = 0;
+    *count = strtoull( s, &end, 10 );
+    if( !isdigit( (unsigned char)*s )
+    || *end
+    || !*count
+    || errno
+    )
+        return ~0;
+    return 0;
+}
+/*
+ * Characters a type draws from, without the ambiguous ones with
+ * --no-ambiguous; 0 for types whose length is not in characters.
+ */
+static
+unsigned
+E_main_I_alphabet( enum output_type type
+, unsigned filter
+, char *chars
+){  const char *ranges = "";
+    const char *table = "";
+    unsigned table_n = 0;
+    switch(type)
+    { case ty_hard:
+      case ty_ascii:        ranges = "!~"; break;
+      case ty_lascii:       ranges = "!@[~"; break;
+      case ty_uascii:       ranges = "!`{~"; break;
+      case ty_anum:         ranges = "09AZaz"; break;
+      case ty_lcase:        ranges = "09az"; break;
+      case ty_ucase:        ranges = "09AZ"; break;
+      case ty_alpha:        ranges = "AZaz"; break;
+      case ty_alcase:       ranges = "az"; break;
+      case ty_aucase:       ranges = "AZ"; break;
+      case ty_hex:          ranges = "09af"; break;
+      case ty_uhex:         ranges = "09AF"; break;
+      case ty_dec:          ranges = "09"; break;
+      case ty_oct:          ranges = "07"; break;
+      case ty_binary:       ranges = "01"; break;
+      case ty_base64url:    table = E_encode_S_base64url; table_n = 64; break;
+      case ty_base32:       table = E_encode_S_base32; table_n = 32; break;
+      case ty_base32c:      table = E_encode_S_base32_crockford; table_n = 32; break;
+      case ty_base58:       table = E_encode_S_base58; table_n = 58; break;
+      default:              return 0;
+    }
+    unsigned n = 0;
+    for( ; *ranges; ranges += 2 )
+        for( int c = ranges[0]; c <= ranges[1]; c++ )
+            chars[ n++ ] = c;
+    for( unsigned i = 0; i != table_n; i++ )
+        chars[ n++ ] = table[i];
+    if( filter & E_pattern_J_no_ambiguous )
+    {   unsigned i = 0;
+        for( unsigned j = 0; j != n; j++ )
+            if( !strchr( E_pattern_S_ambiguous, chars[j] ))
+                chars[ i++ ] = chars[j];
+        n = i;
+    }
+    return n;
+}
+/*
+ * Patterns: items are filled straight into the output buffer from the pool,
+ * refilled once per chunk of items with their precompiled mean number of
+ * bits (with rejections) and the most one item needs without them.
+ */
+#define E_main_J_pattern_chunk  4096
+static
+int
+E_main_I_print_I_pattern( const struct E_main_Z_spec *spec
+){  const struct E_pattern_Z *pattern = spec->pattern;
+    size_t item_n = spec->decor ? pattern->length * 2 + 3 : pattern->length + 1;
+    size_t items = E_main_J_pattern_chunk / item_n;
+    if( !items )
+        items = 1;
+    char *buf = malloc( items * item_n + pattern->length );
+    if( !buf )
+        return ~0;
+    char *item = buf + items * item_n;  /* Unescaped item for --c */
+    uint64_t resampled = 0;
+    int ret = 0;
+    uint64_t k = spec->first;
+    while( k != spec->last )
+    {   size_t chunk = J_min( spec->last - k, items );
+        if( !E_random_S_keyed
+        && E_random_I_prepare_data( chunk * pattern->mean_bits + pattern->bits )
+        )
+        {   ret = ~0;
+            break;
+        }
+        char *s = buf;
+        for( size_t i = 0; i != chunk; i++, k++ )
+        {   if( E_random_S_keyed )
+                E_random_I_seek(k);
+            if( E_random_I_prepare_data( pattern->bits )
+            || E_pattern_I_fill( pattern, spec->decor ? item : s, &resampled )
+            )
+            {   ret = ~0;
+                goto End;
+            }
+            if( spec->decor )
+            {   *s++ = '\"';
+                for( size_t j = 0; j != pattern->length; j++ )
+                {   if( item[j] == '\"'
+                    || item[j] == '\\'
+                    || item[j] == '\''
+                    )
+                        *s++ = '\\';
+                    *s++ = item[j];
+                }
+                *s++ = '\"';
+            }else
+                s += pattern->length;
+            *s++ = '\n';
+        }
+        fwrite( buf, 1, s - buf, E_main_S_out );
+    }
+End:
+    free(buf);
+    atomic_fetch_add_explicit( &E_main_S_stats_chars, ( k - spec->first ) * pattern->slots_n, memory_order_relaxed );
+    atomic_fetch_add_explicit( &E_main_S_stats_resampled, resampled, memory_order_relaxed );
+    return ret;
+}
+/*
+ * Parses an IPv4 ("10.20.0.0/16") or MAC ("02:1a:2b", "02-1a-2b-00-00-00/24")
+ * prefix; without an explicit length all the given octets are the prefix.
+ */
+static
+int
+E_main_I_parse_prefix( const char *s
+, _Bool mac
+, uint64_t *prefix
+, unsigned *prefix_bits
+){  unsigned width = mac ? 48 : 32;
+    unsigned octets = 0;
+    uint64_t v = 0;
+    while(true)
+    {   /* Only digits: strtoul would also take a sign, blanks and "0x" */
+        if( !( mac ? isxdigit( (unsigned char)*s ) : isdigit( (unsigned char)*s )))
+            return ~0;
+        char *end;
+        unsigned long c = strtoul( s, &end, mac ? 16 : 10 );
+        if( end - s > ( mac ? 2 : 3 )
+        || c > 255
+        || octets == width / 8
+        )
+            return ~0;
+        v = v << 8 | c;
+        octets++;
+        s = end;
+        if( !( mac ? *s == ':' || *s == '-' : *s == '.' ))
+            break;
+        s++;
+    }
+    unsigned bits = octets * 8;
+    if( *s == '/' )
+    {   char *end;
+        if( !isdigit( (unsigned char)s[1] ))
+            return ~0;
+        bits = strtoul( s + 1, &end, 10 );
+        if( *end
+        || bits > width
+        )
+            return ~0;
+    }else if( *s )
+        return ~0;
+    v <<= width - octets * 8;
+    *prefix = v & ~J_mask( width - bits );
+    *prefix_bits = bits;
+    return 0;
+}
+/*
+ * Enumerates count distinct addresses within a prefix: address k is the
+ * prefix with host part k passed through a keyed permutation, so neither
+ * duplicates nor memory proportional to the count are possible. For IPv4
+ * the network and broadcast addresses are excluded (except in /31 and /32).
+ */
+static
+int
+E_main_I_print_I_enumerate( enum output_type type
+, uint64_t prefix
+, unsigned prefix_bits
+, uint64_t first
+, uint64_t last
+, uint64_t count
+, int decor
+){  unsigned width = type == ty_ip ? 32 : 48;
+    uint64_t host = 0;
+    uint64_t domain = (uint64_t)1 << ( width - prefix_bits );
+    if( type == ty_ip
+    && width - prefix_bits >= 2
+    )
+    {   host = 1;
+        domain -= 2;
+    }
+    if( count > domain )
+    {   fprintf( stderr, "%s: only %llu addresses in the prefix\n", E_main_S_program, (unsigned long long)domain );
+        return ~0;
+    }
+    uint64_t keys[ E_permute_J_rounds ];
+    if( E_random_S_keyed ) /* Same permutation on every shard */
+        E_random_I_seek( ~0ULL );
+    if( E_random_I_prepare_data( E_permute_J_rounds * 64 ))
+        return ~0;
+    for( unsigned i = 0; i != E_permute_J_rounds; i++ )
+        keys[i] = E_random_R_bits(32) | (uint64_t)E_random_R_bits(32) << 32;
+    struct E_permute_Z permute;
+    E_permute_M( &permute, domain, keys );
+    for( uint64_t k = first; k != last; k++ )
+    {   uint64_t a = prefix | ( host + E_permute_R( &permute, k ));
+        if(decor)
+            putc( '\"', E_main_S_out );
+        if( type == ty_ip )
+            fprintf( E_main_S_out, "%u.%u.%u.%u", (unsigned)( a >> 24 ), (unsigned)( a >> 16 ) & 0xff, (unsigned)( a >> 8 ) & 0xff, (unsigned)a & 0xff );
+        else
+            for( unsigned i = 0; i != 6; i++ )
+            {   fprintf( E_main_S_out, type == ty_umac ? "%02X" : "%02x", (unsigned)( a >> ( 40 - i * 8 )) & 0xff );
+                if( i != 5 )
+                    putc( ':', E_main_S_out );
+            }
+        if(decor)
+            putc( '\"', E_main_S_out );
+        putc( '\n', E_main_S_out );
+    }
     return 0;
 }
 static
 int
 E_main_I_print( enum output_type type
-, int n
+, uint64_t n
 , int decor
-){  switch(type)
+, struct E_main_Z_filter *filter
+){  if( filter
+    && filter->direct
+    )
+        return E_main_I_print_I_ranges( n, decor, 0, 0, filter );
+    switch(type)
     { case ty_hard:
         {   struct E_main_Z_min_max ranges[] =
             { 0x21, 0x2f
@@ -192,48 +887,35 @@ E_main_I_print( enum output_type type
             , 0x7b, 0x7e
             };
             unsigned ranges_n = n < J_a_R_n(ranges) ? n : J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data(bits))
-                return ~0;
             unsigned range_c[ ranges_n ];
-            range_c[0] = E_random_R_bits(bits);
-            range_c[0] = E_main_I_print_I_ranges_I_chars( range_c[0], ranges_n, ranges );
+            if( E_main_I_print_I_ranges_I_draw( &range_c[0], ranges_n, ranges ))
+                return ~0;
             unsigned ranges_n_ = ranges_n;
             if( --ranges_n_ )
             {   struct E_main_Z_min_max range = { 'A', 'Z' };
-                unsigned bits = E_main_I_print_I_ranges_I_bits( 1, &range );
-                if( E_random_I_prepare_data(bits))
+                if( E_main_I_print_I_ranges_I_draw( &range_c[1], 1, &range ))
                     return ~0;
-                range_c[1] = E_random_R_bits( E_main_I_print_I_ranges_I_bits( 1, &range ));
-                range_c[1] = E_main_I_print_I_ranges_I_chars( range_c[1], 1, &range );
                 if( --ranges_n_ )
                 {   struct E_main_Z_min_max range = { 'a', 'z' };
-                    unsigned bits = E_main_I_print_I_ranges_I_bits( 1, &range );
-                    if( E_random_I_prepare_data(bits))
+                    if( E_main_I_print_I_ranges_I_draw( &range_c[2], 1, &range ))
                         return ~0;
-                    range_c[2] = E_random_R_bits( E_main_I_print_I_ranges_I_bits( 1, &range ));
-                    range_c[2] = E_main_I_print_I_ranges_I_chars( range_c[2], 1, &range );
                     if( --ranges_n_ )
                     {   struct E_main_Z_min_max range = { '0', '9' };
-                        unsigned bits = E_main_I_print_I_ranges_I_bits( 1, &range );
-                        if( E_random_I_prepare_data(bits))
+                        if( E_main_I_print_I_ranges_I_draw( &range_c[3], 1, &range ))
                             return ~0;
-                        range_c[3] = E_random_R_bits( E_main_I_print_I_ranges_I_bits( 1, &range ));
-                        range_c[3] = E_main_I_print_I_ranges_I_chars( range_c[3], 1, &range );
                     }
                 }
             }
             if( n > 1 )
             {   unsigned bits = 0;
                 for( unsigned i = 0; i != ranges_n; i++ )
-                    bits += bits_in_count( n - i );
+                    bits += bits_in_count64( n - i );
                 if( E_random_I_prepare_data(bits))
                     return ~0;
-                unsigned pos[ ranges_n ];
+                uint64_t pos[ ranges_n ];
                 _Bool pos_had[ ranges_n ];
                 for( unsigned i = 0; i != ranges_n; i++ )
-                {   pos[i] = E_random_R_bits( bits_in_count( n - i ));
-                    pos[i] = E_main_I_print_I_ranges_I_chars( pos[i], 1, &( struct E_main_Z_min_max ){ 0, n - 1 - i });
+                {   pos[i] = E_main_R_bits64( bits_in_count64( n - i )) % ( n - i );
                     for( unsigned j = 0; j != ranges_n; j++ )
                         pos_had[j] = false;
                     for( unsigned j = 0; j != i; j++ )
@@ -247,22 +929,31 @@ E_main_I_print( enum output_type type
                     }
                 }
                 struct E_main_Z_min_max range = { 0x21, 0x7e };
-                bits = E_main_I_print_I_ranges_I_bits( 1, &range );
-                if( E_random_I_prepare_data(( n - ranges_n ) * bits ))
-                    return ~0;
-                for( unsigned i = 0; i != n; i++ )
-                {   unsigned c;
-                    unsigned j;
-                    for( j = 0; j != ranges_n; j++ )
-                        if( pos[j] == i )
-                        {   c = range_c[j];
-                            break;
+                unsigned count = E_main_I_print_I_ranges_I_count( 1, &range );
+                bits = bits_in_count(count);
+                unsigned mean_bits = ( bits << bits ) / count + 1;
+                for( uint64_t i = 0; i != n; )
+                {   unsigned chunk = J_min( n - i, E_main_J_ranges_chunk );
+                    if( E_random_I_prepare_data( chunk * mean_bits ))
+                        return ~0;
+                    for( uint64_t end = i + chunk; i != end; i++ )
+                    {   unsigned c;
+                        unsigned j;
+                        for( j = 0; j != ranges_n; j++ )
+                            if( pos[j] == i )
+                            {   c = range_c[j];
+                                break;
+                            }
+                        if( j == ranges_n )
+                        {   do
+                            {   if( E_random_I_prepare_data(bits))
+                                    return ~0;
+                                c = E_random_R_bits(bits);
+                            }while( c > range.max - range.min );
+                            c += range.min;
                         }
-                    if( j == ranges_n )
-                    {   c = E_random_R_bits(bits);
-                        c = E_main_I_print_I_ranges_I_chars( c, 1, &range );
+                        cputc( c, decor );
                     }
-                    cputc( c, decor );
                 }
             }else
             {   cputc( range_c[0], decor );
@@ -270,7 +961,7 @@ E_main_I_print( enum output_type type
             break;
         }
       case ty_ascii:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ 0x21, 0x7e }))
+            if( E_main_I_print_I_ranges( n, decor, 1, &( struct E_main_Z_min_max ){ 0x21, 0x7e }, filter ))
                 return ~0;
             break;
       case ty_lascii:
@@ -278,15 +969,8 @@ E_main_I_print( enum output_type type
             { 0x21, 0x40
             , 0x5b, 0x7e
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_uascii:
@@ -294,15 +978,8 @@ E_main_I_print( enum output_type type
             { 0x21, 0x60
             , 0x7b, 0x7e
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_anum:
@@ -311,15 +988,8 @@ E_main_I_print( enum output_type type
             , 'A', 'Z'
             , 'a', 'z'
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_lcase:
@@ -327,15 +997,8 @@ E_main_I_print( enum output_type type
             { '0', '9'
             , 'a', 'z'
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_ucase:
@@ -343,15 +1006,8 @@ E_main_I_print( enum output_type type
             { '0', '9'
             , 'A', 'Z'
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_alpha:
@@ -359,120 +1015,649 @@ E_main_I_print( enum output_type type
             { 'A', 'Z'
             , 'a', 'z'
             };
-            unsigned ranges_n = J_a_R_n(ranges);
-            unsigned bits = E_main_I_print_I_ranges_I_bits( ranges_n, ranges );
-            if( E_random_I_prepare_data( n * bits ))
+            if( E_main_I_print_I_ranges( n, decor, J_a_R_n(ranges), ranges, filter ))
                 return ~0;
-            do
-            {   unsigned c = E_random_R_bits(bits);
-                c = E_main_I_print_I_ranges_I_chars( c, ranges_n, ranges );
-                cputc( c, decor );
-            }while( --n );
             break;
         }
       case ty_alcase:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ 'a', 'z' }))
+            if( E_main_I_print_I_ranges( n, decor, 1, &( struct E_main_Z_min_max ){ 'a', 'z' }, filter ))
                 return ~0;
             break;
       case ty_aucase:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ 'A', 'Z' }))
+            if( E_main_I_print_I_ranges( n, decor, 1, &( struct E_main_Z_min_max ){ 'A', 'Z' }, filter ))
                 return ~0;
             break;
       case ty_hex:
-        {   if( E_random_I_prepare_data( n * 4 ))
+            if( E_main_I_print_I_radix( n, 4, "0123456789abcdef", filter ))
                 return ~0;
-            do
-            {   printf( "%01x", E_random_R_bits(4) );
-            }while( --n );
             break;
-        }
       case ty_uhex:
-        {   if( E_random_I_prepare_data( n * 4 ))
+            if( E_main_I_print_I_radix( n, 4, "0123456789ABCDEF", filter ))
                 return ~0;
-            do
-            {   printf( "%01X", E_random_R_bits(4) );
-            }while( --n );
             break;
-        }
       case ty_dec:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ '0', '9' }))
+            if( E_main_I_print_I_decimal( n, filter ))
                 return ~0;
             break;
       case ty_oct:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ '0', '7' }))
+            if( E_main_I_print_I_radix( n, 3, "01234567", filter ))
                 return ~0;
             break;
       case ty_binary:
-            if( E_main_I_print_I_ranges( type, n, decor, 1, &( struct E_main_Z_min_max ){ '0', '1' }))
+            if( E_main_I_print_I_radix( n, 1, "01", filter ))
                 return ~0;
             break;
       case ty_ip:
-        {   unsigned bits = E_main_I_print_I_ranges_I_bits( 1, &( struct E_main_Z_min_max ){ 0, 255 });
-            if( E_random_I_prepare_data( n * bits ))
-                return ~0;
+        {   unsigned bits = bits_in_count( E_main_I_print_I_ranges_I_count( 1, &( struct E_main_Z_min_max ){ 0, 255 }));
             unsigned n_ = n;
             do
-            {   unsigned c = E_random_R_bits(bits);
-                if( n_ == 1 )
-                    if( !c )
-                        c == 1;
-                    else if( c > 254 )
-                        c = c - ( 254 + 1 ) + 1;
-                else if( n_ == n )
-                    if( !c )
-                        c == 1;
-                printf( "%u", c );
+            {   if( E_random_I_prepare_data( n_ * bits ))
+                    return ~0;
+                unsigned c = E_random_R_bits(bits);
+                if( n_ == n
+                || n_ == 1
+                )   /* Neither the first nor the last octet may be 0 or 255 */
+                    while( !c
+                    || c == 255
+                    )
+                    {   if( E_random_I_prepare_data( n_ * bits ))
+                            return ~0;
+                        c = E_random_R_bits(bits);
+                    }
+                fprintf( E_main_S_out, "%u", c );
                 if( n_ != 1 )
-                    putchar( '.' );
+                    putc( '.', E_main_S_out );
             }while( --n_ );
             break;
         }
       case ty_mac:
         {   if( E_random_I_prepare_data( n * 8 ))
                 return ~0;
+            unsigned n_ = n;
             do
-            {   printf( "%02x", E_random_R_bits(8) );
+            {   unsigned c = E_random_R_bits(8);
+                if( n_ == n )  /* Unicast, locally administered */
+                    c = ( c & ~1 ) | 2;
+                fprintf( E_main_S_out, "%02x", c );
                 if( n != 1 )
-                    putchar( ':' );
+                    putc( ':', E_main_S_out );
             }while( --n );
             break;
         }
       case ty_umac:
         {   if( E_random_I_prepare_data( n * 8 ))
                 return ~0;
+            unsigned n_ = n;
             do
-            {   printf( "%02X", E_random_R_bits(8) );
+            {   unsigned c = E_random_R_bits(8);
+                if( n_ == n )  /* Unicast, locally administered */
+                    c = ( c & ~1 ) | 2;
+                fprintf( E_main_S_out, "%02X", c );
                 if( n != 1 )
-                    putchar( ':' );
+                    putc( ':', E_main_S_out );
             }while( --n );
             break;
         }
-      case ty_uuid:
-        {   if( E_random_I_prepare_data( 16 * 8 ))
+      case ty_base64url:
+            if( E_main_I_print_I_radix( n, 6, E_encode_S_base64url, filter ))
                 return ~0;
-            printf( "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x", E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8) );
             break;
-        }
+      case ty_base32:
+            if( E_main_I_print_I_radix( n, 5, E_encode_S_base32, filter ))
+                return ~0;
+            break;
+      case ty_base32c:
+            if( E_main_I_print_I_radix( n, 5, E_encode_S_base32_crockford, filter ))
+                return ~0;
+            break;
+      case ty_base58:
+            if( E_main_I_print_I_base58( n, filter ))
+                return ~0;
+            break;
+      case ty_uuid:          /* Printed by E_main_I_print_I_uuid */
       case ty_uuuid:
-        {   if( E_random_I_prepare_data( 16 * 8 ))
+      case ty_pattern:       /* Printed by E_main_I_print_I_pattern */
+            return ~0;
+    }
+    return 0;
+}
+/*
+ * Parses the arguments after the type: a length (or for addresses a prefix)
+ * and a count; "-" leaves the default.
+ */
+static
+int
+E_main_I_spec_I_args( struct E_main_Z_spec *spec
+, int argc
+, char *argv[]
+){  int i = 0;
+    if( i != argc
+    && (( spec->type == ty_ip
+        && strpbrk( argv[i], "./" )
+      )
+      || (( spec->type == ty_mac
+          || spec->type == ty_umac
+        )
+        && strpbrk( argv[i], ":-/" )
+        && strcmp( argv[i], "-" )
+    )))
+    {   if( E_main_I_parse_prefix( argv[i], spec->type != ty_ip, &spec->prefix, &spec->prefix_bits ))
+            return ~0;
+        spec->enumerate = true;
+        i++;
+    }else if( i != argc
+    && spec->type != ty_pattern
+    )
+    {   if( strcmp( argv[i], "-" ))
+        {   char *end;
+            errno = 0;
+            unsigned long long length = strtoull( argv[i], &end, 10 );
+            if( *end == 'b' )
+            {   spec->length_in_bits = true;
+                end++;
+            }
+            if( *end
+            || !length
+            || *argv[i] == '-'
+            || errno
+            )
+                return ~0;
+            spec->elements = length;
+            if(( spec->type == ty_ip
+              && spec->elements > 4
+            )
+            || (( spec->type == ty_mac
+                || spec->type == ty_umac
+              )
+              && spec->elements > 6
+            ))
+                return ~0;
+            if( spec->type == ty_uuid
+            || spec->type == ty_uuuid
+            )
+                spec->count = length;
+        }
+        i++;
+    }
+    if( i != argc )
+    {   if( strcmp( argv[i], "-" )
+        && E_main_I_parse_count( argv[i], &spec->count )
+        )
+            return ~0;
+        i++;
+    }
+    return i != argc ? ~0 : 0;
+}
+/*
+ * Applies --lower/--upper and converts a length in bits to characters.
+ */
+static
+int
+E_main_I_spec_I_finish( struct E_main_Z_spec *spec
+, int monocase
+){  if(monocase)
+        switch( spec->type )
+        { case ty_ascii:
+          case ty_anum:
+          case ty_alpha:
+                spec->type += monocase;
+                break;
+          case ty_hex:
+          case ty_mac:
+          case ty_uuid:
+                spec->type += monocase-1;
+                break;
+          default:
                 return ~0;
-            printf( "%02X%02X%02X%02X-%02X%02X-%02X%02X-%02X%02X-%02X%02X%02X%02X%02X%02X", E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8), E_random_R_bits(8) );
+        }
+    char chars[256];
+    unsigned chars_n = E_main_I_alphabet( spec->type, spec->filter, chars );
+    /* Choices left for a character after the filters reject some */
+    unsigned choices_n = chars_n - !!( spec->filter & E_pattern_J_no_repeat ) - !!( spec->filter & E_pattern_J_no_sequence );
+    if( spec->filter
+    && spec->type != ty_pattern
+    && ( spec->type == ty_hard
+      || chars_n < 2
+      || choices_n < 1
+    ))
+        return ~0;
+    if( spec->length_in_bits )
+    {   if( chars_n < 2
+        || choices_n < 2
+        )
+            return ~0;
+        spec->elements = ceil( spec->elements / log2( spec->filter ? choices_n : chars_n ));
+    }
+    return 0;
+}
+/*
+ * Outputs items [first, last) of a spec.
+ */
+static
+int
+E_main_I_run( const struct E_main_Z_spec *spec
+){  enum output_type type = spec->type;
+    int decor = spec->decor;
+    if( type == ty_uuid
+    || type == ty_uuuid
+    )
+        return E_main_I_print_I_uuid( spec->first, spec->last - spec->first, type == ty_uuuid, decor );
+    if( spec->enumerate )
+        return E_main_I_print_I_enumerate( type, spec->prefix, spec->prefix_bits, spec->first, spec->last, spec->count, decor );
+    if( type == ty_pattern )
+        return E_main_I_print_I_pattern(spec);
+    struct E_main_Z_filter filter_, *filter = 0;
+    if( spec->filter )
+    {   filter = &filter_;
+        filter->flags = spec->filter;
+        filter->chars_n = E_main_I_alphabet( type, spec->filter, filter->chars );
+        filter->bits = bits_in_count( filter->chars_n );
+        /* Rejected: the ambiguous characters, and about one choice of those
+         * left for each of the other filters */
+        char chars[256];
+        unsigned all_n = E_main_I_alphabet( type, 0, chars );
+        double rejected = 1 - (double)filter->chars_n / all_n
+        + ( !!( spec->filter & E_pattern_J_no_repeat ) + !!( spec->filter & E_pattern_J_no_sequence )) / (double)filter->chars_n;
+        /* Encoding the whole alphabet would redraw every ambiguous character */
+        filter->direct = filter->chars_n != all_n;
+        if( filter->direct )
+            rejected -= 1 - (double)filter->chars_n / all_n;
+        filter->redraw_bits = ceil( 2 * 1024 * rejected * ( filter->bits << filter->bits ) / filter->chars_n );
+        filter->banned[0] = 0;
+        for( int prev = 0; prev != 256; prev++ )
+            filter->banned[ prev + 1 ] = E_pattern_J_reject( filter->flags, prev, prev )
+            | ( prev != 255 && E_pattern_J_reject( filter->flags, prev + 1, prev )) << 1;
+        filter->resampled = 0;
+    }
+    for( uint64_t k = spec->first; k != spec->last; k++ )
+    {   if( E_random_S_keyed )
+            E_random_I_seek(k);
+        if(filter)
+            filter->prev = -1;
+        if(decor)
+            switch(type)
+            { case ty_hex:
+              case ty_uhex:
+                    putc( '0', E_main_S_out );
+                    putc( 'x', E_main_S_out );
+                    break;
+              case ty_oct:
+                    putc( '0', E_main_S_out );
+                    break;
+              case ty_dec:
+                    /* Do nothing - handled later */
+                    break;
+              default:
+                    putc( '\"', E_main_S_out );
+                    break;
+            }
+        if( E_main_I_print( type, spec->elements, decor, filter ))
+            return ~0;
+        if(decor)
+            switch(type)
+            { case ty_hex:
+              case ty_uhex:
+              case ty_oct:
+              case ty_dec:
+                    /* Do nothing */
+                    break;
+              default:
+                    putc( '\"', E_main_S_out );
+                    break;
+            }
+        putc( '\n', E_main_S_out );
+    }
+    if(filter)
+    {   atomic_fetch_add_explicit( &E_main_S_stats_chars, ( spec->last - spec->first ) * spec->elements, memory_order_relaxed );
+        atomic_fetch_add_explicit( &E_main_S_stats_resampled, filter->resampled, memory_order_relaxed );
+    }
+    return 0;
+}
+/*
+ * Batch mode: each line of the input is a spec
+ *
+ *   TYPE [LENGTH [COUNT [c|- [LABEL]]]]
+ *
+ * with TYPE the long option name of the type, "-" for a default, "c" as
+ * for --c and "#" starting a comment.  All the specs are parsed first, then
+ * run in parallel by worker threads, each sharing the open random source but
+ * with its own bit pool.  Every output line is prefixed by the label (the
+ * line number by default) and a tab; the job of the earliest spec not yet
+ * written goes straight to stdout and the others hold their output until
+ * their turn (E_main_I_batch_I_write), so it stays in input order.
+ */
+static
+int
+E_main_I_batch_I_parse( FILE *in
+){  char *line = 0;
+    size_t line_size = 0;
+    unsigned line_i = 0;
+    while( getline( &line, &line_size, in ) != -1 )
+    {   line_i++;
+        char *argv[5];
+        int argc = 0;
+        char *s = line;
+        while(true)
+        {   s += strspn( s, " \t\r\n" );
+            if( !*s
+            || *s == '#'
+            )
+                break;
+            if( argc == J_a_R_n(argv) )
+                goto Error;
+            argv[ argc++ ] = s;
+            if( *s == '"' ) /* Quoted: may hold blanks and "#"; \" and \\ escape */
+            {   char *d = s++;
+                argv[ argc - 1 ] = d;
+                while( *s != '"' )
+                {   if( !*s )
+                        goto Error;
+                    if( *s == '\\'
+                    && ( s[1] == '"'
+                      || s[1] == '\\'
+                    ))
+                        s++;
+                    *d++ = *s++;
+                }
+                s++;
+                if( *s
+                && !strchr( " \t\r\n#", *s )
+                )
+                    goto Error;
+                *d = '\0';
+                continue;
+            }
+            s += strcspn( s, " \t\r\n#" );
+            if( *s == '#' )
+            {   *s = '\0';
+                break;
+            }
+            if( *s )
+                *s++ = '\0';
+        }
+        if( !argc )
+            continue;
+        if( !( E_main_S_batch_n % 16 ))
+        {   struct E_main_Z_batch *batch = realloc( E_main_S_batch, ( E_main_S_batch_n + 16 ) * sizeof( *batch ));
+            if( !batch )
+                goto Error;
+            E_main_S_batch = batch;
+        }
+        struct E_main_Z_batch *job = &E_main_S_batch[ E_main_S_batch_n ];
+        memset( job, 0, sizeof( *job ));
+        unsigned i;
+        for( i = 0; i != J_a_R_n( E_main_S_batch_types ); i++ )
+            if( !strcmp( argv[0], E_main_S_batch_types[i].name ))
+                break;
+        if( i == J_a_R_n( E_main_S_batch_types ))
+            goto Error;
+        job->spec.type = E_main_S_batch_types[i].type;
+        job->spec.elements = E_main_S_batch_types[i].elements;
+        job->spec.count = 1;
+        if( argc > 3 )
+        {   if( !strcmp( argv[3], "c" ))
+                job->spec.decor = 1;
+            else if( strcmp( argv[3], "-" ))
+                goto Error;
+        }
+        int args_i = 1;
+        if( job->spec.type == ty_pattern )
+        {   struct E_pattern_Z *pattern;
+            if( argc < 2
+            || !( pattern = malloc( sizeof( *pattern )))
+            )
+                goto Error;
+            if( E_pattern_M( pattern, argv[1], E_main_S_filter ))
+            {   free(pattern);
+                goto Error;
+            }
+            job->spec.pattern = pattern;
+            args_i = 2;
+        }
+        /* The filters apply only to the types that draw from an alphabet */
+        char chars[256];
+        if( job->spec.type == ty_pattern
+        || ( job->spec.type != ty_hard
+          && E_main_I_alphabet( job->spec.type, 0, chars )
+        ))
+            job->spec.filter = E_main_S_filter;
+        if( E_main_I_spec_I_args( &job->spec, J_min( argc, 3 ) - args_i, argv + args_i )
+        || E_main_I_spec_I_finish( &job->spec, 0 )
+        )
+            goto Error;
+        job->spec.first = 0;
+        job->spec.last = job->spec.count;
+        char number[ sizeof( line_i ) * 3 + 1 ];
+        sprintf( number, "%u", line_i );
+        job->label = strdup( argc > 4 ? argv[4] : number );
+        if( !job->label )
+            goto Error;
+        E_main_S_batch_n++;
+    }
+    free(line);
+    return ferror(in) ? ~0 : 0;
+Error:
+    fprintf( stderr, "%s: batch line %u: invalid spec\n", E_main_S_program, line_i );
+    free(line);
+    return ~0;
+}
+/*
+ * Output stream of a batch job: every line is prefixed with the label of the
+ * job.  The head of line job writes straight to stdout; the others keep up to
+ * E_main_J_batch_buffer bytes and then wait for their turn.
+ */
+#define E_main_J_batch_buffer   ( 1 << 20 )
+static
+ssize_t
+E_main_I_batch_I_write( void *cookie
+, const char *s
+, size_t n
+){  struct E_main_Z_batch *job = cookie;
+    size_t label_n = strlen( job->label );
+    size_t size = n;
+    _Bool midline = job->midline;
+    for( size_t i = 0; i != n; i++ )
+    {   if( !midline )
+            size += label_n + 1;
+        midline = s[i] != '\n';
+    }
+    pthread_mutex_lock( &E_main_S_batch_mutex );
+    while( job != &E_main_S_batch[ E_main_S_batch_head ]
+    && job->out_n + size > E_main_J_batch_buffer
+    )
+        pthread_cond_wait( &E_main_S_batch_cond, &E_main_S_batch_mutex );
+    _Bool head = job == &E_main_S_batch[ E_main_S_batch_head ];
+    pthread_mutex_unlock( &E_main_S_batch_mutex );
+    if(head)
+    {   if( job->out_n )
+        {   fwrite( job->out, 1, job->out_n, stdout );
+            job->out_n = 0;
+        }
+        for( const char *end = s + n; s != end; )
+        {   const char *nl = memchr( s, '\n', end - s );
+            nl = nl ? nl + 1 : end;
+            if( !job->midline )
+            {   fputs( job->label, stdout );
+                putc( '\t', stdout );
+            }
+            fwrite( s, 1, nl - s, stdout );
+            job->midline = nl[-1] != '\n';
+            s = nl;
+        }
+        return ferror(stdout) ? -1 : (ssize_t)n;
+    }
+    if( job->out_n + size > job->out_size )
+    {   char *out = realloc( job->out, job->out_n + size );
+        if( !out )
+            return -1;
+        job->out = out;
+        job->out_size = job->out_n + size;
+    }
+    for( size_t i = 0; i != n; i++ )
+    {   if( !job->midline )
+        {   memcpy( job->out + job->out_n, job->label, label_n );
+            job->out_n += label_n;
+            job->out[ job->out_n++ ] = '\t';
+        }
+        job->out[ job->out_n++ ] = s[i];
+        job->midline = s[i] != '\n';
+    }
+    return n;
+}
+static
+void *
+E_main_I_batch_I_worker( void *arg
+){  while(true)
+    {   pthread_mutex_lock( &E_main_S_batch_mutex );
+        size_t i = E_main_S_batch_next++;
+        pthread_mutex_unlock( &E_main_S_batch_mutex );
+        if( i >= E_main_S_batch_n )
             break;
+        struct E_main_Z_batch *job = &E_main_S_batch[i];
+#ifdef HAVE_FOPENCOOKIE
+        E_main_S_out = fopencookie( job, "w", ( cookie_io_functions_t ){ .write = E_main_I_batch_I_write });
+#else
+        /* Without a custom stream the output is held whole and labelled at the end */
+        char *out = 0;
+        size_t out_n = 0;
+        E_main_S_out = open_memstream( &out, &out_n );
+#endif
+        if( !E_main_S_out
+        || E_main_I_run( &job->spec )
+        )
+            job->ret = ~0;
+        if( E_main_S_out )
+        {   if( ferror( E_main_S_out ))
+                job->ret = ~0;
+            if( fclose( E_main_S_out ))
+                job->ret = ~0;
+#ifndef HAVE_FOPENCOOKIE
+            if( !job->ret
+            && out_n
+            && E_main_I_batch_I_write( job, out, out_n ) != (ssize_t)out_n
+            )
+                job->ret = ~0;
+            free(out);
+#endif
+        }
+        pthread_mutex_lock( &E_main_S_batch_mutex );
+        job->done = true;
+        pthread_cond_broadcast( &E_main_S_batch_cond );
+        pthread_mutex_unlock( &E_main_S_batch_mutex );
+    }
+    E_random_W();
+    return arg;
+}
+static
+int
+E_main_I_batch( const char *path
+){  FILE *in = strcmp( path, "-" ) ? fopen( path, "r" ) : stdin;
+    if( !in )
+    {   fprintf( stderr, "%s: cannot open %s\n", E_main_S_program, path );
+        return ~0;
+    }
+    int ret = E_main_I_batch_I_parse(in);
+    if( in != stdin )
+        fclose(in);
+    if(ret)
+        return ret;
+    if( E_main_S_uuid_version != 4 )
+    {   size_t i;
+        for( i = 0; i != E_main_S_batch_n; i++ )
+            if( E_main_S_batch[i].spec.type == ty_uuid
+            || E_main_S_batch[i].spec.type == ty_uuuid
+            )
+                break;
+        if( i == E_main_S_batch_n )
+        {   fprintf( stderr, "%s: --uuid-version needs a uuid spec in the batch\n", E_main_S_program );
+            return ~0;
         }
     }
+    long threads_n = sysconf( _SC_NPROCESSORS_ONLN );
+    if( threads_n < 1 )
+        threads_n = 1;
+    if( (size_t)threads_n > E_main_S_batch_n )
+        threads_n = E_main_S_batch_n;
+    pthread_t threads[ threads_n ? threads_n : 1 ];
+    long threads_started = 0;
+    while( threads_started != threads_n
+    && !pthread_create( &threads[ threads_started ], 0, E_main_I_batch_I_worker, 0 )
+    )
+        threads_started++;
+    if( !threads_started
+    && E_main_S_batch_n
+    )
+    {   fprintf( stderr, "%s: cannot create threads\n", E_main_S_program );
+        return ~0;
+    }
+    for( size_t i = 0; i != E_main_S_batch_n; i++ )
+    {   struct E_main_Z_batch *job = &E_main_S_batch[i];
+        pthread_mutex_lock( &E_main_S_batch_mutex );
+        E_main_S_batch_head = i;
+        pthread_cond_broadcast( &E_main_S_batch_cond );
+        while( !job->done )
+            pthread_cond_wait( &E_main_S_batch_cond, &E_main_S_batch_mutex );
+        pthread_mutex_unlock( &E_main_S_batch_mutex );
+        if( job->ret )
+        {   fprintf( stderr, "%s: batch spec %s failed\n", E_main_S_program, job->label );
+            ret = ~0;
+        }else
+            fwrite( job->out, 1, job->out_n, stdout ); /* Done before its turn */
+        free( job->out );
+        free( job->label );
+        if( job->spec.pattern )
+        {   E_pattern_W( job->spec.pattern );
+            free( job->spec.pattern );
+        }
+    }
+    for( long i = 0; i != threads_started; i++ )
+        pthread_join( threads[i], 0 );
+    free( E_main_S_batch );
+    if( fflush(stdout)
+    || ferror(stdout)
+    )
+    {   fprintf( stderr, "%s: cannot write the batch output\n", E_main_S_program );
+        ret = ~0;
+    }
+    return ret;
+}
+static
+void
+E_main_I_stats( void
+){  fflush(stdout);
+    fprintf( stderr, "%s: random source: %s\n", E_main_S_program, E_random_R_source() );
+    fprintf( stderr, "%s: random bytes: %llu in %llu refills\n", E_main_S_program
+    , (unsigned long long)E_random_S_stats_bytes, (unsigned long long)E_random_S_stats_refills
+    );
+    if( E_main_S_filter )
+        fprintf( stderr, "%s: filters resampled %llu of %llu characters (%.3f%%)\n", E_main_S_program
+        , (unsigned long long)E_main_S_stats_resampled, (unsigned long long)E_main_S_stats_chars
+        , E_main_S_stats_chars ? 100.0 * E_main_S_stats_resampled / E_main_S_stats_chars : 0
+        );
+    if( E_random_S_stats_hardware_failures )
+        fprintf( stderr, "%s: refills read from the kernel after RDRAND failed: %llu\n", E_main_S_program
+        , (unsigned long long)E_random_S_stats_hardware_failures
+        );
 }
 int
 main( int argc
 , char *argv[]
 ){  int opt;
-    int passwords = 1;
-    int elements = 12;		/* Characters wanted */
+    struct E_main_Z_spec spec = { 0 };
+    const char *batch = 0;
+    _Bool stats = false, version = false;
+    struct E_pattern_Z pattern;
+    const char *pattern_s = 0;
+    uint64_t elements = 12;	/* Characters wanted */
     int decor = 0;		    /* Precede hex numbers with 0x, oct with 0 */
     int monocase = 0;		/* 1 for lower, 2 for upper */
     enum output_type type = ty_ascii;
-    int i;
+    unsigned char key[32];
+    uint64_t shard_i = 0, shard_n = 1;
+    _Bool keyed = false, sharded = false;
 
     E_main_S_program = argv[0];
+    E_main_S_out = stdout;
     _Bool type_selected = false;
     while(( opt = getopt_long(argc, argv, short_options, long_options, NULL)) != EOF )
         switch(opt)
@@ -586,9 +1771,52 @@ main( int argc
                 type_selected = true;
                 type = ty_uuuid;
                 break;
+          case OPT_BASE64URL:
+                if( type_selected )
+                    usage(1);
+                type_selected = true;
+                type = ty_base64url;
+                break;
+          case OPT_BASE32:
+                if( type_selected )
+                    usage(1);
+                type_selected = true;
+                type = ty_base32;
+                break;
+          case OPT_BASE32C:
+                if( type_selected )
+                    usage(1);
+                type_selected = true;
+                type = ty_base32c;
+                break;
+          case OPT_BASE58:
+                if( type_selected )
+                    usage(1);
+                type_selected = true;
+                type = ty_base58;
+                break;
+          case OPT_PATTERN:
+                if( type_selected )
+                    usage(1);
+                type_selected = true;
+                type = ty_pattern;
+                pattern_s = optarg;
+                break;
+          case OPT_NO_REPEAT:
+                E_main_S_filter |= E_pattern_J_no_repeat;
+                break;
+          case OPT_NO_SEQUENCE:
+                E_main_S_filter |= E_pattern_J_no_sequence;
+                break;
+          case OPT_NO_AMBIGUOUS:
+                E_main_S_filter |= E_pattern_J_no_ambiguous;
+                break;
           case 's':		        /* Use /dev/random, not /dev/urandom */
                 E_random_S_secure_source = true;
                 break;
+          case OPT_HARDWARE:	/* RDRAND/RDSEED keyed ChaCha20 */
+                E_random_S_hardware_source = true;
+                break;
           case 'c':			    /* C constant */
                 decor = 1;
                 break;
@@ -601,94 +1829,123 @@ main( int argc
           case 'h':
                 usage(0);
                 break;
+          case OPT_KEY:
+                for( unsigned i = 0; i != sizeof(key); i++ )
+                {   unsigned d;
+                    if( !isxdigit( optarg[ i * 2 ] )
+                    || !isxdigit( optarg[ i * 2 + 1 ] )
+                    || sscanf( optarg + i * 2, "%2x", &d ) != 1
+                    )
+                        usage(1);
+                    key[i] = d;
+                }
+                if( optarg[ sizeof(key) * 2 ] )
+                    usage(1);
+                keyed = true;
+                break;
+          case OPT_SHARD:
+            {   char *end;
+                errno = 0;
+                shard_i = strtoull( optarg, &end, 10 );
+                if( !isdigit( (unsigned char)*optarg )
+                || *end != '/'
+                || errno
+                )
+                    usage(1);
+                if( E_main_I_parse_count( end + 1, &shard_n )
+                || shard_i >= shard_n
+                )
+                    usage(1);
+                sharded = true;
+                break;
+            }
+          case OPT_BATCH:
+                batch = optarg;
+                break;
+          case OPT_UUID_VERSION:
+            {   char *end;
+                unsigned long version = strtoul( optarg, &end, 10 );
+                if( !isdigit( (unsigned char)*optarg )
+                || *end
+                || ( version != 4
+                  && version != 7
+                ))
+                    usage(1);
+                E_main_S_uuid_version = version;
+                break;
+            }
+          case OPT_STATS:
+                stats = true;
+                break;
           case 'V':
-                printf( "%s %s\n", PACKAGE_NAME, PACKAGE_VERSION );
-                exit(0);
+                version = true;
+                break;
           default:
                 usage(1);
                 break;
         }
-    if( optind != argc )
-    {   elements = atoi( argv[optind] );
-        if( !elements
-        || ( type == ty_ip
-          && elements > 4
-        )
-        || (( type == ty_mac
-            || type == ty_umac
-          )
-          && elements > 6
-        ))
-            usage(1);
-        if( type == ty_uuid
-        || type == ty_uuuid
-        )
-            passwords = elements;
-        optind++;
+    if(version) /* After the options, as the source depends on --secure, --hardware and --key */
+    {   E_random_M();
+        printf( "%s %s\nrandom source: %s\n", PACKAGE_NAME, PACKAGE_VERSION, E_random_R_source() );
+        return 0;
     }
-    if( optind != argc )
-    {   if( type == ty_uuid
-        || type == ty_uuuid
+    if(batch)
+    {   if( type_selected
+        || optind != argc
+        || decor
+        || monocase
+        || keyed
+        || sharded
         )
             usage(1);
-        passwords = atoi( argv[optind] );
-        if( !passwords )
+        E_random_M();
+        int ret = E_main_I_batch(batch) ? 1 : 0;
+        if(stats)
+            E_main_I_stats();
+        return ret;
+    }
+    if( pattern_s )
+    {   if( E_pattern_M( &pattern, pattern_s, E_main_S_filter ))
+        {   fprintf( stderr, "%s: invalid pattern: %s\n", E_main_S_program, pattern_s );
             usage(1);
-        optind++;
+        }
+        spec.pattern = &pattern;
     }
-    if( optind != argc )
+    spec.type = type;
+    spec.elements = elements;
+    spec.decor = decor;
+    spec.filter = E_main_S_filter;
+    spec.count = 1;
+    if( E_main_I_spec_I_args( &spec, argc - optind, argv + optind )
+    || E_main_I_spec_I_finish( &spec, monocase )
+    )
         usage(1);
-    /* Adjust type for monocasing */
-    if(monocase)
-        switch(type)
-        { case ty_ascii:
-          case ty_anum:
-          case ty_alpha:
-                type += monocase;
-                break;
-          case ty_hex:
-          case ty_mac:
-          case ty_uuid:
-                type += monocase-1;
-                break;
-          default:
-                usage(1);
-                break;
-        }
+    if( E_main_S_uuid_version != 4
+    && spec.type != ty_uuid
+    && spec.type != ty_uuuid
+    )
+        usage(1);
+    if( sharded
+    && !keyed
+    )
+    {   fprintf( stderr, "%s: --shard needs a common --key\n", E_main_S_program );
+        usage(1);
+    }
+    if( keyed
+    && E_main_S_uuid_version == 7
+    )
+    {   fprintf( stderr, "%s: version 7 UUIDs depend on the clock, not only on --key\n", E_main_S_program );
+        usage(1);
+    }
+    /* Items of this shard: [ count * i / n, count * ( i + 1 ) / n ) */
+    spec.first = (unsigned __int128)spec.count * shard_i / shard_n;
+    spec.last = (unsigned __int128)spec.count * ( shard_i + 1 ) / shard_n;
     E_random_M();
-    do
-    {   if(decor)
-            switch(type)
-            { case ty_hex:
-              case ty_uhex:
-                    putchar('0');
-                    putchar('x');
-                    break;
-              case ty_oct:
-                    putchar('0');
-                    break;
-              case ty_dec:
-                    /* Do nothing - handled later */
-                    break;
-              default:
-                    putchar('\"');
-                    break;
-            }
-        E_main_I_print( type, elements, decor );
-        if(decor)
-            switch(type)
-            { case ty_hex:
-              case ty_uhex:
-              case ty_oct:
-              case ty_dec:
-                    /* Do nothing */
-                    break;
-              default:
-                    putchar('\"');
-                    break;
-            }
-        putchar('\n');
-    }while( --passwords );
-    return 0;
+    if(keyed)
+        E_random_I_key(key);
+    int ret = E_main_I_run( &spec ) ? 1 : 0;
+    if(stats)
+        E_main_I_stats();
+    return ret;
 }
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
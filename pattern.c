@@ -0,0 +1,226 @@
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "main.h"
+#include "pattern.h"
+#include "random.h"
+//==============================================================================
+#define E_pattern_J_max_length  ( 1 << 16 )
+#define E_pattern_J_literal     0x40000000
+//==============================================================================
+/*
+ * Pattern language: "9" a digit, "A" / "a" an upper / lower case letter,
+ * "X" / "x" an upper / lower case letter or digit, "H" / "h" an upper /
+ * lower case hexadecimal digit, "*" any printable ASCII character but space,
+ * "[...]" a class of characters and "c-d" ranges, "{n}" n times the
+ * preceding character or class, "\c" the character c; anything else stands
+ * for itself.
+ * It is compiled into a template with the literal characters in place and a
+ * flat list of class slots, each with the offset to fill, its alphabet, and
+ * the random bits needed from it to the end of the item.
+ */
+static const struct
+{ char c;
+  const char *ranges;
+} E_pattern_S_shorthand[] =
+{ { '9', "09" }
+, { 'A', "AZ" }
+, { 'a', "az" }
+, { 'X', "09AZ" }
+, { 'x', "09az" }
+, { 'H', "09AF" }
+, { 'h', "09af" }
+, { '*', "!~" }
+};
+/*
+ * Glyphs mistaken for one another, as excluded by "pwgen -B".
+ */
+const char E_pattern_S_ambiguous[] = "B8G6I1l0OQDS5Z2";
+//==============================================================================
+static
+int
+E_pattern_M_I_class( struct E_pattern_Z *pattern
+, const _Bool set[256]
+){  struct E_pattern_Z_class class = { 0 };
+    for( unsigned c = 1; c != 256; c++ )
+        if( set[c]
+        && !( pattern->filter & E_pattern_J_no_ambiguous
+          && strchr( E_pattern_S_ambiguous, c )
+        ))
+            class.chars[ class.n++ ] = c;
+    if( !class.n )
+        return -1;
+    if( class.n == 1 ) // Jeden znak to zwykły znak wzorca.
+        return (unsigned char)class.chars[0] | E_pattern_J_literal;
+    if( class.n <= !!( pattern->filter & E_pattern_J_no_repeat ) + !!( pattern->filter & E_pattern_J_no_sequence )) // Każdy poprzedni znak musi zostawić wybór.
+        return -1;
+    class.bits = sizeof(unsigned) * 8 - __builtin_clz( class.n - 1 );
+    for( size_t i = 0; i != pattern->classes_n; i++ )
+        if( pattern->classes[i].n == class.n
+        && !memcmp( pattern->classes[i].chars, class.chars, class.n )
+        )
+            return i;
+    struct E_pattern_Z_class *classes = realloc( pattern->classes, ( pattern->classes_n + 1 ) * sizeof( *classes ));
+    if( !classes )
+        return -1;
+    pattern->classes = classes;
+    classes[ pattern->classes_n ] = class;
+    return pattern->classes_n++;
+}
+static
+int
+E_pattern_M_I_append( struct E_pattern_Z *pattern
+, int item
+){  if( pattern->length == E_pattern_J_max_length )
+        return ~0;
+    if( item & E_pattern_J_literal )
+    {   pattern->template[ pattern->length++ ] = item;
+        return 0;
+    }
+    if( !( pattern->slots_n % 64 ))
+    {   struct E_pattern_Z_slot *slots = realloc( pattern->slots, ( pattern->slots_n + 64 ) * sizeof( *slots ));
+        if( !slots )
+            return ~0;
+        pattern->slots = slots;
+    }
+    pattern->slots[ pattern->slots_n ].offset = pattern->length;
+    pattern->slots[ pattern->slots_n ].class = item;
+    pattern->slots_n++;
+    pattern->template[ pattern->length++ ] = '?';
+    return 0;
+}
+int
+E_pattern_M( struct E_pattern_Z *pattern
+, const char *s
+, unsigned filter
+){  memset( pattern, 0, sizeof( *pattern ));
+    pattern->filter = filter;
+    if( !( pattern->template = malloc( E_pattern_J_max_length )))
+        return ~0;
+    int item = -1;
+    while( *s )
+    {   _Bool set[256] = { false };
+        unsigned char c = *s++;
+        unsigned i;
+        for( i = 0; i != J_a_R_n( E_pattern_S_shorthand ); i++ )
+            if( c == E_pattern_S_shorthand[i].c )
+                break;
+        if( i != J_a_R_n( E_pattern_S_shorthand ))
+        {   for( const char *r = E_pattern_S_shorthand[i].ranges; *r; r += 2 )
+                for( unsigned d = (unsigned char)r[0]; d <= (unsigned char)r[1]; d++ )
+                    set[d] = true;
+            item = E_pattern_M_I_class( pattern, set );
+        }else if( c == '[' )
+        {   while( *s != ']' )
+            {   if( *s == '\\' )
+                    s++;
+                unsigned char first = *s++;
+                if( !first )
+                    goto Error;
+                unsigned char last = first;
+                if( *s == '-'
+                && s[1]
+                && s[1] != ']'
+                )
+                {   s++;
+                    if( *s == '\\' )
+                        s++;
+                    last = *s++;
+                    if( !last
+                    || last < first
+                    )
+                        goto Error;
+                }
+                for( unsigned d = first; d <= last; d++ )
+                    set[d] = true;
+            }
+            s++;
+            item = E_pattern_M_I_class( pattern, set );
+        }else if( c == '{' )
+        {   char *end;
+            unsigned long n = strtoul( s, &end, 10 );
+            if( item == -1
+            || end == s
+            || *end != '}'
+            || !n
+            || n > E_pattern_J_max_length
+            )
+                goto Error;
+            s = end + 1;
+            while( --n )
+                if( E_pattern_M_I_append( pattern, item ))
+                    goto Error;
+            item = -1; // "{n}{m}" jest błędem.
+            continue;
+        }else
+        {   if( c == '\\' )
+            {   c = *s++;
+                if( !c )
+                    goto Error;
+            }
+            item = c | E_pattern_J_literal;
+        }
+        if( item == -1
+        || E_pattern_M_I_append( pattern, item )
+        )
+            goto Error;
+    }
+    if( !pattern->slots_n ) // Pusty lub bez żadnej klasy: każdy element byłby taki sam.
+        goto Error;
+    char *template = realloc( pattern->template, pattern->length );
+    if( !template )
+        goto Error;
+    pattern->template = template;
+    size_t rest_bits = 0;
+    double mean_bits = 0;
+    for( size_t i = pattern->slots_n; i--; )
+    {   const struct E_pattern_Z_class *class = &pattern->classes[ pattern->slots[i].class ];
+        rest_bits += class->bits;
+        mean_bits += (double)class->bits * ( 1U << class->bits ) / class->n; // Z odrzuceniami.
+        pattern->slots[i].rest_bits = rest_bits;
+    }
+    pattern->bits = rest_bits;
+    pattern->mean_bits = mean_bits * 17 / 16 + 1; // Zapas na wariancję odrzuceń.
+    return 0;
+Error:
+    E_pattern_W(pattern);
+    return ~0;
+}
+void
+E_pattern_W( struct E_pattern_Z *pattern
+){  free( pattern->template );
+    free( pattern->slots );
+    free( pattern->classes );
+    memset( pattern, 0, sizeof( *pattern ));
+}
+/*
+ * Fills one item of "pattern->length" characters at "dst". The pool must hold
+ * "pattern->bits" bits; only a draw outside of a class that is not a power of
+ * two, or one the filters reject after the preceding character, refills for
+ * the rest of the item and resamples that slot; the latter are counted in
+ * "*resampled".
+ */
+int
+E_pattern_I_fill( const struct E_pattern_Z *pattern
+, char *dst
+, uint64_t *resampled
+){  memcpy( dst, pattern->template, pattern->length );
+    for( size_t i = 0; i != pattern->slots_n; i++ )
+    {   const struct E_pattern_Z_slot *slot = &pattern->slots[i];
+        const struct E_pattern_Z_class *class = &pattern->classes[ slot->class ];
+        int prev = slot->offset ? (unsigned char)dst[ slot->offset - 1 ] : -1;
+        unsigned v = E_random_R_bits( class->bits );
+        while( v >= class->n
+        || ( E_pattern_J_reject( pattern->filter, (unsigned char)class->chars[v], prev )
+          && ++*resampled
+        ))
+        {   if( E_random_I_prepare_data( slot->rest_bits ))
+                return ~0;
+            v = E_random_R_bits( class->bits );
+        }
+        dst[ slot->offset ] = class->chars[v];
+    }
+    return 0;
+}
+/******************************************************************************/
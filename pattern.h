@@ -0,0 +1,39 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#define E_pattern_J_no_repeat       1
+#define E_pattern_J_no_sequence     2
+#define E_pattern_J_no_ambiguous    4
+/* Whether character "c" may not follow "prev" under the filters; a sequence
+ * needs both alphanumeric, so in one class (digit, upper or lower case) */
+#define E_pattern_J_reject(filter,c,prev) \
+    (( (filter) & E_pattern_J_no_repeat && (c) == (prev) ) \
+    | ( (filter) & E_pattern_J_no_sequence && (c) == (prev) + 1 && isalnum( (unsigned char)(c) ) && isalnum( (unsigned char)(prev) )))
+extern const char E_pattern_S_ambiguous[];
+struct E_pattern_Z_class
+{ unsigned n;
+  unsigned bits;
+  char chars[256];
+};
+struct E_pattern_Z_slot
+{ unsigned offset;
+  unsigned class;
+  size_t rest_bits;
+};
+struct E_pattern_Z
+{ char *template;
+  size_t length;
+  struct E_pattern_Z_slot *slots;
+  size_t slots_n;
+  struct E_pattern_Z_class *classes;
+  size_t classes_n;
+  size_t bits;
+  size_t mean_bits;
+  unsigned filter;
+};
+int E_pattern_M( struct E_pattern_Z *, const char *, unsigned );
+void E_pattern_W( struct E_pattern_Z * );
+int E_pattern_I_fill( const struct E_pattern_Z *, char *, uint64_t * );
+#endif
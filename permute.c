@@ -0,0 +1,53 @@
+/******************************************************************************/
+#include <stdint.h>
+#include "main.h"
+#include "permute.h"
+//==============================================================================
+/*
+ * Keyed permutation of [0, domain): a balanced Feistel network over the
+ * smallest even number of bits covering the domain, with cycle walking for
+ * results outside of it. Index k maps to a distinct element in O(1) expected
+ * time (the network's range is at most 4 times the domain) and no memory.
+ */
+void
+E_permute_M( struct E_permute_Z *permute
+, uint64_t domain
+, const uint64_t *keys
+){  unsigned bits = domain > 1 ? sizeof(uint64_t) * 8 - __builtin_clzll( domain - 1 ) : 1;
+    permute->domain = domain;
+    permute->half_bits = ( bits + 1 ) / 2;
+    for( unsigned i = 0; i != E_permute_J_rounds; i++ )
+        permute->keys[i] = keys[i];
+}
+static
+uint64_t
+E_permute_I_round( uint64_t key
+, uint64_t x
+){  x += key; // Funkcja mieszająca z "splitmix64".
+    x = ( x ^ ( x >> 30 )) * 0xbf58476d1ce4e5b9ULL;
+    x = ( x ^ ( x >> 27 )) * 0x94d049bb133111ebULL;
+    return x ^ ( x >> 31 );
+}
+static
+uint64_t
+E_permute_I_feistel( const struct E_permute_Z *permute
+, uint64_t x
+){  uint64_t mask = J_mask( permute->half_bits );
+    uint64_t l = x >> permute->half_bits;
+    uint64_t r = x & mask;
+    for( unsigned i = 0; i != E_permute_J_rounds; i++ )
+    {   uint64_t t = r;
+        r = l ^ ( E_permute_I_round( permute->keys[i], r ) & mask );
+        l = t;
+    }
+    return l << permute->half_bits | r;
+}
+uint64_t
+E_permute_R( const struct E_permute_Z *permute
+, uint64_t k
+){  do
+    {   k = E_permute_I_feistel( permute, k );
+    }while( k >= permute->domain );
+    return k;
+}
+/******************************************************************************/
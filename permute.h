@@ -0,0 +1,12 @@
+#ifndef PERMUTE_H
+#define PERMUTE_H
+#include <stdint.h>
+#define E_permute_J_rounds      8
+struct E_permute_Z
+{ uint64_t domain;
+  unsigned half_bits;
+  uint64_t keys[ E_permute_J_rounds ];
+};
+void E_permute_M( struct E_permute_Z *, uint64_t, const uint64_t * );
+uint64_t E_permute_R( const struct E_permute_Z *, uint64_t );
+#endif
@@ -2,21 +2,97 @@
 #include <assert.h>
 #include <ctype.h>
 #include <fcntl.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include "main.h"
+#include "random.h"
+#if defined( __x86_64__ )
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 //==============================================================================
 extern const char *E_main_S_program;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 _Bool E_random_S_secure_source;     /* true if we should use /dev/random */
+_Bool E_random_S_hardware_source;   /* true if RDRAND/RDSEED should key the pool */
+_Bool E_random_S_keyed;             /* true if items are generated from a key */
+unsigned E_random_S_hardware;       /* E_random_J_hardware_* instructions keying the pool */
+atomic_ullong E_random_S_stats_bytes, E_random_S_stats_refills, E_random_S_stats_hardware_failures;
 static int E_random_S_random_fd;
-static unsigned char *E_random_S_data;
-static size_t E_random_S_n_bits;
-static size_t E_random_S_i_bit;
+static uint32_t E_random_S_key[8];
+// Pula bitów i pozycja w strumieniu są osobne dla każdego wątku, wspólne są tylko źródło i klucz.
+static _Thread_local unsigned char *E_random_S_data;
+static _Thread_local size_t E_random_S_data_n;
+static _Thread_local size_t E_random_S_n_bits;
+static _Thread_local size_t E_random_S_i_bit;
+static _Thread_local unsigned long long E_random_S_rand_d;
+static _Thread_local unsigned E_random_S_rand_n;
+static _Thread_local uint64_t E_random_S_item;
+static _Thread_local uint64_t E_random_S_block;
+static _Thread_local unsigned char E_random_S_stream[64];
+static _Thread_local unsigned E_random_S_stream_i;
+static _Thread_local uint32_t E_random_S_hardware_key[8];
+static _Thread_local size_t E_random_S_hardware_left;
 //==============================================================================
+#define E_random_J_hardware_reseed  ( 1 << 20 )
+#if defined( __x86_64__ )
+__attribute__(( target( "rdrnd" )))
+static
+int
+E_random_M_hardware_I_rdrand( unsigned long long *d
+){  for( unsigned i = 0; i != 10; i++ ) // Zalecane przez Intela 10 ponowień.
+        if( _rdrand64_step(d) )
+            return 0;
+    return ~0;
+}
+__attribute__(( target( "rdseed" )))
+static
+int
+E_random_M_hardware_I_rdseed( unsigned long long *d
+){  for( unsigned i = 0; i != 1000; i++ ) // RDSEED może się wyczerpać; wtedy czeka.
+    {   if( _rdseed64_step(d) )
+            return 0;
+        _mm_pause();
+    }
+    return ~0;
+}
+/*
+ * Sprzętowe źródło służy tylko do kluczowania: każdy wątek ma własny klucz
+ * ChaCha20 z danych "/dev/urandom" XOR RDSEED (lub RDRAND), odnawiany co
+ * "E_random_J_hardware_reseed" bajtów, a pula to strumień tego klucza.
+ */
+static
+void
+E_random_M_hardware( void
+){  unsigned a, b, c, d;
+    if( !__get_cpuid( 1, &a, &b, &c, &d )
+    || !( c & bit_RDRND )
+    )
+        return;
+    unsigned hardware = E_random_J_hardware_rdrand;
+    if( __get_cpuid_max( 0, 0 ) >= 7 )
+    {   __cpuid_count( 7, 0, a, b, c, d );
+        if( b & bit_RDSEED )
+            hardware |= E_random_J_hardware_rdseed;
+    }
+    unsigned long long v[4]; // Wadliwy procesor (np. AMD po uśpieniu) zwraca stałe wartości RDRAND.
+    for( unsigned i = 0; i != J_a_R_n(v); i++ )
+        if( E_random_M_hardware_I_rdrand( &v[i] ))
+            return;
+    if( v[0] == v[1]
+    && v[1] == v[2]
+    && v[2] == v[3]
+    )
+        return;
+    E_random_S_hardware = hardware;
+}
+#endif
 void
 E_random_M( void
 ){  E_random_S_random_fd = open( E_random_S_secure_source ? "/dev/random" : "/dev/urandom", O_RDONLY );
@@ -32,163 +108,241 @@ E_random_M( void
         pid_t pid = getpid();
         srand( t ^ pid );		/* As secure as we can get... */
 	}
+#if defined( __x86_64__ )
+    else if( E_random_S_hardware_source
+    && !E_random_S_secure_source
+    )
+        E_random_M_hardware();
+#endif
+}
+const char *
+E_random_R_source( void
+){  if( E_random_S_keyed )
+        return "ChaCha20 with --key";
+    if( E_random_S_hardware & E_random_J_hardware_rdseed )
+        return "RDRAND, RDSEED and /dev/urandom";
+    if( E_random_S_hardware )
+        return "RDRAND and /dev/urandom";
+    if( ~E_random_S_random_fd )
+        return E_random_S_secure_source ? "/dev/random" : "/dev/urandom";
+    return "rand";
+}
+// Zwalnia pulę bitów bieżącego wątku.
+void
+E_random_W( void
+){  free( E_random_S_data );
+    E_random_S_data = 0;
+    E_random_S_data_n = E_random_S_n_bits = E_random_S_i_bit = 0;
+}
+/*
+ * Tryb z kluczem: dane dla elementu k to strumień ChaCha20 z kluczem i
+ * jednorazowym numerem k (64 bitowy licznik bloków, jak w oryginalnej
+ * wersji D. J. Bernsteina), więc element zależy tylko od (klucz, k).
+ */
+void
+E_random_I_seek( uint64_t item
+){  E_random_S_item = item;
+    E_random_S_block = 0;
+    E_random_S_stream_i = sizeof( E_random_S_stream );
+    E_random_S_n_bits = E_random_S_i_bit = 0;
+}
+void
+E_random_I_key( const unsigned char *key
+){  for( unsigned i = 0; i != 8; i++ )
+        E_random_S_key[i] = (uint32_t)key[ i * 4 ] | (uint32_t)key[ i * 4 + 1 ] << 8 | (uint32_t)key[ i * 4 + 2 ] << 16 | (uint32_t)key[ i * 4 + 3 ] << 24;
+    E_random_S_keyed = true;
+    E_random_I_seek(0);
+}
+#define E_random_J_chacha20_quarter(a,b,c,d) \
+    a += b; d ^= a; d = d << 16 | d >> 16; \
+    c += d; b ^= c; b = b << 12 | b >> 20; \
+    a += b; d ^= a; d = d << 8 | d >> 24; \
+    c += d; b ^= c; b = b << 7 | b >> 25
+static
+void
+E_random_I_chacha20( const uint32_t *key
+, unsigned char *out
+){  uint32_t s[16] =
+    { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+    , key[0], key[1], key[2], key[3]
+    , key[4], key[5], key[6], key[7]
+    , E_random_S_block, E_random_S_block >> 32, E_random_S_item, E_random_S_item >> 32
+    };
+    uint32_t x[16];
+    memcpy( x, s, sizeof(x) );
+    for( unsigned i = 0; i != 10; i++ )
+    {   E_random_J_chacha20_quarter( x[0], x[4], x[8], x[12] );
+        E_random_J_chacha20_quarter( x[1], x[5], x[9], x[13] );
+        E_random_J_chacha20_quarter( x[2], x[6], x[10], x[14] );
+        E_random_J_chacha20_quarter( x[3], x[7], x[11], x[15] );
+        E_random_J_chacha20_quarter( x[0], x[5], x[10], x[15] );
+        E_random_J_chacha20_quarter( x[1], x[6], x[11], x[12] );
+        E_random_J_chacha20_quarter( x[2], x[7], x[8], x[13] );
+        E_random_J_chacha20_quarter( x[3], x[4], x[9], x[14] );
+    }
+    for( unsigned i = 0; i != 16; i++ )
+    {   uint32_t d = x[i] + s[i];
+        out[ i * 4 ] = d;
+        out[ i * 4 + 1 ] = d >> 8;
+        out[ i * 4 + 2 ] = d >> 16;
+        out[ i * 4 + 3 ] = d >> 24;
+    }
+    E_random_S_block++;
+}
+static
+void
+E_random_I_prepare_data_I_stream( const uint32_t *key
+, unsigned char *data
+, size_t n
+){  while(n)
+    {   if( E_random_S_stream_i == sizeof( E_random_S_stream ))
+        {   if( n >= sizeof( E_random_S_stream )) // Całe bloki bez kopiowania.
+            {   E_random_I_chacha20( key, data );
+                data += sizeof( E_random_S_stream );
+                n -= sizeof( E_random_S_stream );
+                continue;
+            }
+            E_random_I_chacha20( key, E_random_S_stream );
+            E_random_S_stream_i = 0;
+        }
+        size_t i = J_min( n, sizeof( E_random_S_stream ) - E_random_S_stream_i );
+        memcpy( data, E_random_S_stream + E_random_S_stream_i, i );
+        E_random_S_stream_i += i;
+        data += i;
+        n -= i;
+    }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+/*
+ * Pula bitów: nowe dane są wczytywane całymi bajtami na początek bufora,
+ * a pozostałe bity z poprzedniego wczytania są przesuwane za nie.
+ */
+static
+void
+E_random_I_prepare_data_I_move( size_t dst
+, size_t n
+){  size_t src = E_random_S_i_bit / 8;
+    unsigned shift = E_random_S_i_bit % 8;
+    size_t src_n = ( E_random_S_n_bits + 7 ) / 8;
+    unsigned char *data = E_random_S_data;
+    if( dst <= src ) // Kopiując od początku.
+        for( size_t i = 0; i != n; i++ )
+            data[ dst + i ] = data[ src + i ] >> shift
+            | ( shift && src + i + 1 != src_n ? data[ src + i + 1 ] << ( 8 - shift ) : 0 );
+    else // Kopiując od końca.
+        for( size_t i = n; i--; )
+            data[ dst + i ] = data[ src + i ] >> shift
+            | ( shift && src + i + 1 != src_n ? data[ src + i + 1 ] << ( 8 - shift ) : 0 );
+}
+static
+void
+E_random_I_prepare_data_I_rand( unsigned char *data
+, size_t n
+){  unsigned rand_bits = sizeof(unsigned) * 8 - __builtin_clz( RAND_MAX );
+    if( RAND_MAX ^ J_mask( rand_bits ))
+        rand_bits >>= 1;
+    while( n-- )
+    {   while( E_random_S_rand_n < 8 ) // Bity z "rand" są zbierane, by żaden nie został pominięty.
+        {   E_random_S_rand_d |= (unsigned long long)( rand() & J_mask( rand_bits )) << E_random_S_rand_n;
+            E_random_S_rand_n += rand_bits;
+        }
+        *data++ = E_random_S_rand_d;
+        E_random_S_rand_d >>= 8;
+        E_random_S_rand_n -= 8;
+    }
+}
 static
 int
-E_random_I_prepare_data_I( size_t bits
-, size_t rand_bits
-, size_t *new_rands
-){  size_t new_bits = bits > E_random_S_n_bits - E_random_S_i_bit ? bits - ( E_random_S_n_bits - E_random_S_i_bit ) : 0;
-    new_bits = J_align_up( new_bits, rand_bits );
-    size_t all_bits = new_bits + ( E_random_S_n_bits - E_random_S_i_bit );
-    size_t bytes = all_bits / 8 + ( all_bits % 8 ? 1 : 0 );
-    unsigned char *data;
-    _Bool realloc_after_move = false;
-    if( bytes > E_random_S_n_bits / 8 + ( E_random_S_n_bits % 8 ? 1 : 0 ))
-    {   data = realloc( E_random_S_data, bytes );
-        if( !data )
+E_random_I_prepare_data_I_read( unsigned char *data
+, size_t n
+){  do
+    {   ssize_t i = read( E_random_S_random_fd, data, n );
+        if( i <= 0 )
             return ~0;
-        E_random_S_data = data;
-    }else
-    {   data = E_random_S_data;
-        realloc_after_move = bytes < E_random_S_n_bits / 8 + ( E_random_S_n_bits % 8 ? 1 : 0 );
+        n -= i;
+        data += i;
+    }while(n);
+    return 0;
+}
+#if defined( __x86_64__ )
+// Nowy klucz wątku: 32 bajty z jądra XOR 4 wartości RDSEED (lub RDRAND).
+static
+int
+E_random_I_hardware_I_reseed( void
+){  unsigned char key[32];
+    if( E_random_I_prepare_data_I_read( key, sizeof(key) ))
+        return ~0;
+    for( unsigned i = 0; i != 4; i++ )
+    {   unsigned long long v;
+        if( !( E_random_S_hardware & E_random_J_hardware_rdseed )
+        || E_random_M_hardware_I_rdseed( &v )
+        )
+            if( E_random_M_hardware_I_rdrand( &v ))
+                return ~0;
+        for( unsigned j = 0; j != 8; j++ )
+            key[ i * 8 + j ] ^= v >> ( j * 8 );
     }
-    if( E_random_S_n_bits - E_random_S_i_bit ) // Przeniesienie pozostałych danych na koniec.
-        if( new_bits < E_random_S_i_bit
-        || new_bits >= E_random_S_n_bits
-        ) // Kopiując od początku.
-        {   size_t dst = new_bits / 8;
-            size_t src = E_random_S_i_bit / 8;
-            unsigned dst_bits = J_min( 8 - new_bits % 8, E_random_S_n_bits - E_random_S_i_bit );
-            unsigned src_bits = ( E_random_S_n_bits - 1 ) / 8 != E_random_S_i_bit / 8
-            ? 8 - E_random_S_i_bit % 8
-            : E_random_S_n_bits - E_random_S_i_bit;
-            if(( E_random_S_n_bits - 1 ) / 8 == E_random_S_i_bit / 8 )
-                data[dst] = data[src] >> ( E_random_S_i_bit % 8 ) << ( new_bits % 8 );
-            else if( dst_bits > src_bits )
-            {   data[dst] = ( data[src] >> ( 8 - src_bits )) << ( new_bits % 8 );
-                src++;
-                data[dst] |= ( data[src] & J_mask( dst_bits - src_bits )) << ( new_bits % 8 + src_bits );
-            }else
-            {   data[dst] = ( data[src] >> ( src_bits - dst_bits )) << ( new_bits % 8 );
-                if( dst_bits == src_bits )
-                    src++;
-            }
-            E_random_S_i_bit += dst_bits;
-            while( E_random_S_i_bit != E_random_S_n_bits )
-            {   dst++;
-                unsigned dst_bits = J_min( 8, E_random_S_n_bits - E_random_S_i_bit );
-                unsigned src_bits = 8 - E_random_S_i_bit % 8;
-                if( dst_bits > src_bits )
-                {   data[dst] = data[src] << ( 8 - src_bits );
-                    src++;
-                    data[dst] |= data[src] & J_mask( dst_bits - src_bits );
-                }else
-                {   data[dst] = data[src] >> ( src_bits - dst_bits );
-                    if( dst_bits == src_bits )
-                        src++;
-                }
-                E_random_S_i_bit += dst_bits;
-            }
-        }else // Kopiując od końca.
-        {   size_t dst = bytes - 1;
-            size_t src = ( E_random_S_n_bits - 1 ) / 8;
-            unsigned dst_bits = ( E_random_S_n_bits - 1 ) / 8 != E_random_S_i_bit / 8
-            ? all_bits % 8
-            : E_random_S_n_bits - E_random_S_i_bit;
-            unsigned src_bits = E_random_S_n_bits
-            - (( E_random_S_n_bits - 1 ) / 8 != E_random_S_i_bit / 8
-              ? J_align_down( E_random_S_n_bits - 1, 8 )
-              : E_random_S_i_bit
-              );
-            if(( E_random_S_n_bits - 1 ) / 8 == E_random_S_i_bit / 8 )
-                data[dst] = data[src] >> ( E_random_S_i_bit % 8 );
-            else if( dst_bits > src_bits )
-            {   data[dst] = data[src] << ( dst_bits - src_bits );
-                src--;
-                data[dst] |= data[src] >> ( 8 - ( dst_bits - src_bits ));
-            }else
-            {   data[dst] = data[src] >> ( src_bits - dst_bits );
-                if( dst_bits == src_bits )
-                    src--;
-            }
-            while( E_random_S_n_bits != E_random_S_i_bit )
-            {   dst--;
-                unsigned dst_bits = J_min( 8, E_random_S_n_bits - E_random_S_i_bit );
-                unsigned src_bits = E_random_S_n_bits - J_align_down( E_random_S_n_bits - 1, 8 );
-                if( dst_bits > src_bits )
-                {   data[dst] = data[src] << ( dst_bits - src_bits );
-                    src--;
-                    data[dst] |= data[src] >> ( 8 - ( dst_bits - src_bits ));
-                }else
-                {   data[dst] = data[src] >> ( src_bits - dst_bits );
-                    if( dst_bits == src_bits )
-                        src--;
-                }
-                E_random_S_n_bits -= dst_bits;
-            }
+    for( unsigned i = 0; i != 8; i++ )
+        E_random_S_hardware_key[i] = (uint32_t)key[ i * 4 ] | (uint32_t)key[ i * 4 + 1 ] << 8 | (uint32_t)key[ i * 4 + 2 ] << 16 | (uint32_t)key[ i * 4 + 3 ] << 24;
+    E_random_S_item = 0;
+    E_random_S_block = 0;
+    E_random_S_stream_i = sizeof( E_random_S_stream );
+    E_random_S_hardware_left = E_random_J_hardware_reseed;
+    return 0;
+}
+static
+int
+E_random_I_prepare_data_I_hardware( unsigned char *data
+, size_t n
+){  while(n)
+    {   if( !E_random_S_hardware_left
+        && E_random_I_hardware_I_reseed()
+        ) // Nie ma nowego klucza: całe dane z jądra.
+        {   atomic_fetch_add_explicit( &E_random_S_stats_hardware_failures, 1, memory_order_relaxed );
+            return E_random_I_prepare_data_I_read( data, n );
         }
-    if( realloc_after_move )
-    {   data = realloc( E_random_S_data, bytes );
-        if( !data )
-            return ~0;
-        E_random_S_data = data;
+        size_t i = J_min( n, E_random_S_hardware_left );
+        E_random_I_prepare_data_I_stream( E_random_S_hardware_key, data, i );
+        E_random_S_hardware_left -= i;
+        data += i;
+        n -= i;
     }
-    *new_rands = new_bits / rand_bits;
-    E_random_S_n_bits = all_bits;
-    E_random_S_i_bit = 0;
     return 0;
 }
+#endif
 int
 E_random_I_prepare_data( size_t bits
-){  if( bits > E_random_S_n_bits - E_random_S_i_bit )
-        if( ~E_random_S_random_fd )
-        {   size_t new_rands;
-            if( E_random_I_prepare_data_I( bits, 8, &new_rands ))
-                return ~0;
-            unsigned char *data = E_random_S_data;
-            do
-            {   int i = read( E_random_S_random_fd, data, new_rands );
-                if( !~i )
-                    return i;
-                new_rands -= i;
-                data += i;
-            }while( new_rands );
-        }else
-        {   unsigned rand_bits = sizeof(unsigned) * 8 - __builtin_clz( RAND_MAX );
-            if( RAND_MAX ^ J_mask( rand_bits ))
-                rand_bits >>= 1;
-            if( rand_bits < 8 )
-                return ~0;
-            size_t new_rands;
-            if( E_random_I_prepare_data_I( bits, rand_bits, &new_rands ))
-                return ~0;
-            if( new_rands )
-            {   unsigned char *data = E_random_S_data;
-                size_t i_bit = 0;
-                *data = 0;
-                do
-                {   unsigned d = rand();
-                    for( unsigned i = 0; i < rand_bits; i += 8 )
-                    {   *data |= (( d >> i ) & J_mask( 8 - i_bit % 8 )) << ( i_bit % 8 );
-                        if( new_rands != 1 )
-                        {   if( i + 8 < rand_bits ) // Jeżeli nie ostatni bajt z rand.
-                                *++data = i_bit % 8 ? ( d >> ( i + 8 - i_bit % 8 )) & J_mask( i_bit % 8 ) : 0;
-                            else if( i_bit % 8 )
-                                *++data = ( i_bit + rand_bits ) % 8 ? ( d >> ( i + 8 - i_bit % 8 )) & J_mask(( i_bit + rand_bits ) % 8 ) : 0;
-                        }else
-                            if( i + 8 < rand_bits )
-                                *++data = i_bit % 8 ? ( d >> ( i + 8 - i_bit % 8 )) & J_mask( i_bit % 8 ) : 0;
-                            else if(( i_bit + rand_bits ) % 8 )
-                            {   data++;
-                                *data = ( *data & ~J_mask(( i_bit + rand_bits ) % 8 )) | (( d >> i ) & J_mask(( i_bit + rand_bits ) % 8 ));
-                            }
-                    }
-                    i_bit += rand_bits;
-                }while( --new_rands );
-            }
-        }
+){  size_t left = E_random_S_n_bits - E_random_S_i_bit;
+    if( bits <= left )
+        return 0;
+    size_t new_bytes = ( bits - left + 7 ) / 8;
+    size_t bytes = new_bytes + ( left + 7 ) / 8;
+    if( bytes > E_random_S_data_n )
+    {   unsigned char *data = realloc( E_random_S_data, bytes );
+        if( !data )
+            return ~0;
+        E_random_S_data = data;
+        E_random_S_data_n = bytes;
+    }
+    if(left)
+        E_random_I_prepare_data_I_move( new_bytes, ( left + 7 ) / 8 );
+    atomic_fetch_add_explicit( &E_random_S_stats_bytes, new_bytes, memory_order_relaxed );
+    atomic_fetch_add_explicit( &E_random_S_stats_refills, 1, memory_order_relaxed );
+    if( E_random_S_keyed )
+        E_random_I_prepare_data_I_stream( E_random_S_key, E_random_S_data, new_bytes );
+#if defined( __x86_64__ )
+    else if( E_random_S_hardware )
+    {   if( E_random_I_prepare_data_I_hardware( E_random_S_data, new_bytes ))
+            return ~0;
+    }
+#endif
+    else if( ~E_random_S_random_fd )
+    {   if( E_random_I_prepare_data_I_read( E_random_S_data, new_bytes ))
+            return ~0;
+    }else
+        E_random_I_prepare_data_I_rand( E_random_S_data, new_bytes );
+    E_random_S_n_bits = new_bytes * 8 + left;
+    E_random_S_i_bit = 0;
     return 0;
 }
 unsigned
@@ -196,14 +350,25 @@ E_random_R_bits( unsigned bits
 ){  assert( bits > 0 && bits <= sizeof(unsigned) * 8 && E_random_S_i_bit + bits <= E_random_S_n_bits );
     size_t byte_i = E_random_S_i_bit / 8;
     unsigned bits_i = E_random_S_i_bit % 8;
-    unsigned d = 0;
-    for( unsigned i = 0; i != sizeof(unsigned); i++ )
-    {   d |= ( E_random_S_data[ byte_i + i ] >> bits_i ) << i * 8;
-        if( bits > i * 8 + 8 - bits_i )
-            break;
-        d |= E_random_S_data[ byte_i + i + 1 ] << ( i * 8 + 8 - bits_i );
-    }
+    unsigned long long d = E_random_S_data[ byte_i ] >> bits_i;
+    for( unsigned i = 8 - bits_i; i < bits; i += 8 ) // Tylko bajty zawierające żądane bity.
+        d |= (unsigned long long)E_random_S_data[ ++byte_i ] << i;
     E_random_S_i_bit += bits;
     return d & J_mask(bits);
 }
+void
+E_random_R_data( unsigned char *dst
+, size_t n
+){  assert( E_random_S_i_bit + n * 8 <= E_random_S_n_bits );
+    if( !( E_random_S_i_bit % 8 )) // Wyrównane do bajtu: bez przesuwania bitów.
+    {   memcpy( dst, E_random_S_data + E_random_S_i_bit / 8, n );
+        E_random_S_i_bit += n * 8;
+    }else // Bajt docelowy z dwóch sąsiednich; ostatni z nich zawiera jeszcze żądane bity.
+    {   const unsigned char *src = E_random_S_data + E_random_S_i_bit / 8;
+        unsigned bits_i = E_random_S_i_bit % 8;
+        for( size_t i = 0; i != n; i++ )
+            dst[i] = src[i] >> bits_i | src[ i + 1 ] << ( 8 - bits_i );
+        E_random_S_i_bit += n * 8;
+    }
+}
 /******************************************************************************/
\ No newline at end of file
@@ -1,6 +1,15 @@
 #ifndef RANDOM_H
 #define RANDOM_H
+#include <stddef.h>
+#include <stdint.h>
+#define E_random_J_hardware_rdrand  1
+#define E_random_J_hardware_rdseed  2
 void E_random_M(void);
+void E_random_W(void);
+const char *E_random_R_source( void );
+void E_random_I_key( const unsigned char * );
+void E_random_I_seek( uint64_t );
 int E_random_I_prepare_data( size_t );
-unsigned char E_random_R_bits(unsigned);
+unsigned E_random_R_bits(unsigned);
+void E_random_R_data( unsigned char *, size_t );
 #endif
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Batch output must come in input order, labelled, with each spec's count and format.
+ranpwd=$1
+specs=$(i=0; while [ $i -lt 200 ]; do echo "hexadecimal $((i % 7 + 1)) $((i % 5 + 1)) - s$i"; i=$((i + 1)); done)
+expected=$(i=0; while [ $i -lt 200 ]; do n=$((i % 5 + 1)); while [ $n -gt 0 ]; do echo "s$i $((i % 7 + 1))"; n=$((n - 1)); done; i=$((i + 1)); done)
+actual=$(echo "$specs" | "$ranpwd" --batch - | awk -F '\t' '$2 ~ /^[0-9a-f]+$/ { print $1, length($2) }') || exit 1
+if [ "$expected" != "$actual" ]
+then
+    echo "batch output differs"
+    exit 1
+fi
+if echo "ip 5" | "$ranpwd" --batch - 2>/dev/null
+then
+    echo "invalid spec accepted"
+    exit 1
+fi
+# Outputs larger than the buffer of a waiting job stay whole and in order.
+actual=$(printf "binary 3000000 - - a\nhexadecimal 3000000 2 - b\nbinary 10 2 - c\n" | "$ranpwd" --batch - | awk -F '\t' '{ print $1, length($2) }') || exit 1
+if [ "$actual" != "$(printf "a 3000000\nb 3000000\nb 3000000\nc 10\nc 10")" ]
+then
+    echo "long batch output differs"
+    exit 1
+fi
+if echo "hexadecimal 8 10" | "$ranpwd" --batch - > /dev/full 2>/dev/null
+then
+    echo "write error not reported"
+    exit 1
+fi
+if echo "hexadecimal 8" | "$ranpwd" --uuid-version 7 --batch - >/dev/null 2>&1 \
+|| "$ranpwd" --uuid-version 7x -g >/dev/null 2>&1
+then
+    echo "invalid --uuid-version accepted"
+    exit 1
+fi
+# Quoted fields may hold blanks and "#".
+actual=$(printf '%s\n' 'pattern "[# ]{6}" 50 - "q l" # comment' | "$ranpwd" --batch - | awk -F '\t' '$1 == "q l" && length($2) == 6 && $2 ~ /^[# ]+$/' | wc -l) || exit 1
+if [ "$actual" -ne 50 ]
+then
+    echo "quoted batch fields not parsed"
+    exit 1
+fi
+if printf '%s\n' 'pattern "XX 1' | "$ranpwd" --batch - 2>/dev/null
+then
+    echo "unterminated quote accepted"
+    exit 1
+fi
@@ -0,0 +1,108 @@
+/******************************************************************************/
+/*
+ * The encoders of "encode.c" (with whatever SIMD path the machine selects)
+ * against straightforward reference encoders, for every length up to a few
+ * SIMD steps.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "../encode.h"
+//==============================================================================
+#define E_test_J_groups         200
+//==============================================================================
+static unsigned char E_test_S_src[ E_test_J_groups * 5 ];
+static char E_test_S_out[ E_test_J_groups * 8 ];
+static char E_test_S_ref[ E_test_J_groups * 8 ];
+//==============================================================================
+/*
+ * Reference: the bits of "src" as one big-endian (MSB-first) or, for binary
+ * and octal, little-endian (LSB-first) stream, "bits" at a time.
+ */
+static
+void
+E_test_I_ref( size_t chars
+, unsigned bits
+, _Bool msb_first
+, unsigned group_bits
+, const char *alphabet
+){  for( size_t i = 0; i != chars; i++ )
+    {   unsigned d = 0;
+        for( unsigned j = 0; j != bits; j++ )
+        {   size_t bit = i * bits + j;
+            size_t group = bit / group_bits;
+            unsigned in_group = bit % group_bits;
+            unsigned v;
+            if( msb_first )
+                v = ( E_test_S_src[ bit / 8 ] >> ( 7 - bit % 8 )) & 1;
+            else
+            {   size_t byte = group * ( group_bits / 8 ) + in_group / 8;
+                v = ( E_test_S_src[byte] >> ( in_group % 8 )) & 1;
+            }
+            d |= msb_first ? v << ( bits - 1 - j ) : v << j;
+        }
+        E_test_S_ref[i] = alphabet[d];
+    }
+}
+static
+int
+E_test_I_check( const char *name
+, size_t groups
+, size_t chars
+){  if( memcmp( E_test_S_out, E_test_S_ref, chars ))
+    {   fprintf( stderr, "%s: %zu groups differ from the reference\n", name, groups );
+        return ~0;
+    }
+    return 0;
+}
+int
+main( void
+){  uint64_t seed = 88172645463325252ULL;
+    for( size_t i = 0; i != sizeof( E_test_S_src ); i++ )
+    {   seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        E_test_S_src[i] = seed;
+    }
+    int ret = 0;
+    for( size_t groups = 0; groups != E_test_J_groups; groups++ )
+    {   E_encode_I_base64url( E_test_S_out, E_test_S_src, groups );
+        E_test_I_ref( groups * 4, 6, true, 24, E_encode_S_base64url );
+        ret |= E_test_I_check( "base64url", groups, groups * 4 );
+        E_encode_I_base32( E_test_S_out, E_test_S_src, groups, E_encode_S_base32 );
+        E_test_I_ref( groups * 8, 5, true, 40, E_encode_S_base32 );
+        ret |= E_test_I_check( "base32", groups, groups * 8 );
+        E_encode_I_base32( E_test_S_out, E_test_S_src, groups, E_encode_S_base32_crockford );
+        E_test_I_ref( groups * 8, 5, true, 40, E_encode_S_base32_crockford );
+        ret |= E_test_I_check( "base32-crockford", groups, groups * 8 );
+        E_encode_I_binary( E_test_S_out, E_test_S_src, groups );
+        E_test_I_ref( groups * 8, 1, false, 8, "01" );
+        ret |= E_test_I_check( "binary", groups, groups * 8 );
+        E_encode_I_octal( E_test_S_out, E_test_S_src, groups );
+        E_test_I_ref( groups * 8, 3, false, 24, "01234567" );
+        ret |= E_test_I_check( "octal", groups, groups * 8 );
+    }
+    for( unsigned v = 0; v != 1000; v++ )
+    {   char s[4];
+        snprintf( s, sizeof(s), "%03u", v );
+        E_encode_I_decimal3( E_test_S_out, v );
+        if( memcmp( E_test_S_out, s, 3 ))
+        {   fprintf( stderr, "decimal: %u\n", v );
+            ret = 1;
+        }
+    }
+    for( uint64_t v = 0; v < 128063081718016ULL; v = v * 3 + 57 )
+    {   char s[9];
+        uint64_t d = v;
+        for( unsigned i = 8; i--; d /= 58 )
+            s[i] = E_encode_S_base58[ d % 58 ];
+        E_encode_I_base58( E_test_S_out, v, 8 );
+        if( memcmp( E_test_S_out, s, 8 ))
+        {   fprintf( stderr, "base58: %llu\n", (unsigned long long)v );
+            ret = 1;
+        }
+    }
+    return ret ? 1 : 0;
+}
+/******************************************************************************/
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Filtered output must have no repeats, no ascending pairs and no ambiguous glyphs.
+ranpwd=$1
+status=0
+pairs="01|12|23|34|45|56|67|78|89|ab|bc|cd|de|ef|fg|gh|hi|ij|jk|kl|lm|mn|no|op|pq|qr|rs|st|tu|uv|vw|wx|xy|yz"
+pairs="$pairs|AB|BC|CD|DE|EF|FG|GH|HI|IJ|JK|KL|LM|MN|NO|OP|PQ|QR|RS|ST|TU|UV|VW|WX|XY|YZ"
+for args in "-a 20 2000" "-x 20 2000" "-x 5000 4" "-d 5000 4" "--base58 20 2000" "--base64url 5000 4" "--ascii 20 2000" "--pattern XXXX-XXXX-9999 2000"
+do
+    out=$("$ranpwd" --no-repeat --no-sequence --no-ambiguous $args) || { echo "failed: $args"; status=1; continue; }
+    if [ "$(printf "%s\n" "$out" | wc -l)" -ne "${args##* }" ] \
+    || printf "%s\n" "$out" | grep -qE "(.)\1|$pairs|[B8G6I1l0OQDS5Z2]"
+    then
+        echo "filter not applied: $args"
+        status=1
+    fi
+done
+# Without the ambiguous filter the bulk encoders' output is redrawn in place.
+for args in "-x 5000 4" "-d 5000 4" "--base32 5000 4" "-l 5000 4"
+do
+    out=$("$ranpwd" --no-repeat --no-sequence $args) || { echo "failed: $args"; status=1; continue; }
+    if printf "%s\n" "$out" | grep -qE "(.)\1|$pairs"
+    then
+        echo "filter not applied: $args"
+        status=1
+    fi
+done
+# In a batch the types without an alphabet are output unfiltered.
+out=$(printf 'alpha 8\nuuid 2\nip 4\nmac-address 6\nhard 8\n' | "$ranpwd" --no-repeat --batch -) \
+|| { echo "batch with a filter failed"; status=1; }
+if [ "$(printf "%s\n" "$out" | wc -l)" -ne 6 ]
+then
+    echo "batch with a filter: wrong line count"
+    status=1
+fi
+# A sequence is only within digits, upper or lower case letters.
+for args in "--pattern [@A]{200}" "--pattern [/0]{200}" "--pattern [\`a]{200}"
+do
+    out=$("$ranpwd" --no-sequence $args) || { echo "failed: $args"; status=1; continue; }
+    case "$out" in
+      *@A*|*/0*|*\`a*) ;;
+      *) echo "pair across classes rejected: $args"; status=1 ;;
+    esac
+done
+if "$ranpwd" --no-repeat -r 12 2>/dev/null >/dev/null \
+|| "$ranpwd" --no-repeat --no-sequence --pattern '[ab]{4}' 2>/dev/null >/dev/null
+then
+    echo "impossible filter accepted"
+    status=1
+fi
+exit $status
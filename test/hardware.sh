@@ -0,0 +1,23 @@
+#!/bin/sh
+# --hardware generates (from the kernel where the processor has no RDRAND)
+# and --stats names the source; --version reports it whatever the order.
+ranpwd=$1
+status=0
+out=$("$ranpwd" --hardware -x 32 100) || { echo "--hardware failed"; exit 1; }
+if [ "$(printf "%s\n" "$out" | grep -cE '^[0-9a-f]{32}$')" -ne 100 ]
+then
+    echo "--hardware: bad output"
+    status=1
+fi
+stats=$("$ranpwd" --hardware --stats -x 32 100 2>&1 >/dev/null) || { echo "--hardware --stats failed"; exit 1; }
+case "$stats" in
+  *"random source: "?*) ;;
+  *) echo "--stats: no random source"; status=1 ;;
+esac
+if [ "$("$ranpwd" --version --secure)" != "$("$ranpwd" --secure --version)" ] \
+|| [ "$("$ranpwd" --version --hardware)" != "$("$ranpwd" --hardware --version)" ]
+then
+    echo "--version depends on the option order"
+    status=1
+fi
+exit $status
@@ -0,0 +1,14 @@
+#!/bin/sh
+# Very long outputs must start at once and fit in a small fixed address space.
+ranpwd=$1
+status=0
+for args in "-r" "-a" "-x" "-d" "-o" "-b" "--base64url" "--base32" "--base58"
+do
+    n=$( (ulimit -v 65536; "$ranpwd" $args 100000000000) | head -c 1000000 | wc -c)
+    if [ "$n" -ne 1000000 ]
+    then
+        echo "long output failed: $args"
+        status=1
+    fi
+done
+exit $status
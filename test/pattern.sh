@@ -0,0 +1,31 @@
+#!/bin/sh
+# Pattern output must match the layout, use every class member, and bad patterns must be refused.
+ranpwd=$1
+status=0
+check()
+{
+    out=$("$ranpwd" --pattern "$1" 2000) || { echo "failed: $1"; status=1; return; }
+    if [ "$(echo "$out" | grep -cxE "$2")" -ne 2000 ]
+    then
+        echo "layout differs: $1"
+        status=1
+    fi
+}
+check 'XXXX-XXXX-9999' '[A-Z0-9]{4}-[A-Z0-9]{4}-[0-9]{4}'
+check '[A-Z]{3}-h{8}' '[A-Z]{3}-[0-9a-f]{8}'
+check '\9\X[x-z]{2}*' '9X[x-z]{2}[!-~]'
+check 'Hax[-_.]' '[0-9A-F][a-z][a-z0-9][-_.]'
+if [ "$("$ranpwd" --pattern '[0-5]' 2000 | sort -u | tr -d '\n')" != "012345" ]
+then
+    echo "class members missing"
+    status=1
+fi
+for bad in '[a-' '[]' '[z-a]' '{3}' 'a{0}' 'a{2}{2}' '\' '' '-.\9' '[a]{4}'
+do
+    if "$ranpwd" --pattern "$bad" 2>/dev/null >/dev/null
+    then
+        echo "invalid pattern accepted: $bad"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,185 @@
+/******************************************************************************/
+/*
+ * Throughput regression test: runs the program for every case of the
+ * baseline file, measures output bytes per second (best of a few runs) and
+ * divides it by the rate of reading "/dev/urandom" on the same machine.
+ * A case fails when this ratio falls below the one stored in the baseline.
+ * Baseline lines: name, minimal ratio, program arguments.  A ratio written
+ * "R@NAME" is instead to the rate of the earlier case NAME, as for a
+ * variant that should cost little over it.
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+//==============================================================================
+#define E_test_J_runs           3
+#define E_test_J_calibration    ( 64 << 20 )
+#define E_test_J_cases          64
+#define E_test_J_args           32
+//==============================================================================
+static
+double
+E_test_R_time( void
+){  struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+static
+double
+E_test_R_calibration( void
+){  static char buf[ 1 << 16 ];
+    int fd = open( "/dev/urandom", O_RDONLY );
+    if( !~fd )
+        return 0;
+    double t = E_test_R_time();
+    for( size_t n = 0; n < E_test_J_calibration; )
+    {   ssize_t i = read( fd, buf, sizeof(buf) );
+        if( i <= 0 )
+            return 0;
+        n += i;
+    }
+    t = E_test_R_time() - t;
+    close(fd);
+    return E_test_J_calibration / t;
+}
+/*
+ * Runs the program once, returns output bytes per second or 0 on failure.
+ */
+static
+double
+E_test_R_rate( char *argv[]
+){  static char buf[ 1 << 16 ];
+    int pipe_fd[2];
+    if( pipe( pipe_fd ))
+        return 0;
+    double t = E_test_R_time();
+    pid_t pid = fork();
+    if( !pid )
+    {   dup2( pipe_fd[1], 1 );
+        close( pipe_fd[0] );
+        close( pipe_fd[1] );
+        execv( argv[0], argv );
+        _exit(127);
+    }
+    close( pipe_fd[1] );
+    size_t n = 0;
+    ssize_t i;
+    while(( i = read( pipe_fd[0], buf, sizeof(buf) )) > 0 )
+        n += i;
+    close( pipe_fd[0] );
+    int status;
+    if( !~waitpid( pid, &status, 0 )
+    || !WIFEXITED(status)
+    || WEXITSTATUS(status)
+    || !n
+    )
+        return 0;
+    return n / ( E_test_R_time() - t );
+}
+/*
+ * Splits a baseline line into the name, the ratio and the arguments of the
+ * program; returns the name or 0 for a blank or comment line.
+ */
+static
+char *
+E_test_I_split( char *line
+, char *program
+, char **ratio_s
+, char *args[ E_test_J_args ]
+){  char *name = strtok( line, " \t\n" );
+    if( !name
+    || *name == '#'
+    )
+        return 0;
+    *ratio_s = strtok( 0, " \t\n" );
+    unsigned args_n = 0;
+    args[ args_n++ ] = program;
+    char *arg;
+    while(( arg = strtok( 0, " \t\n" ))
+    && args_n != E_test_J_args - 1
+    )
+        args[ args_n++ ] = arg;
+    args[ args_n ] = 0;
+    return name;
+}
+int
+main( int argc
+, char *argv[]
+){  if( argc != 3 )
+    {   fprintf( stderr, "usage: %s program baseline\n", argv[0] );
+        return 2;
+    }
+    FILE *baseline = fopen( argv[2], "r" );
+    if( !baseline )
+    {   perror( argv[2] );
+        return 2;
+    }
+    double calibration = E_test_R_calibration();
+    if( !calibration )
+        return 2;
+    printf( "calibration: %.1f MB/s\n", calibration / 1e6 );
+    int ret = 0;
+    char line[256];
+    struct
+    { char line[256];
+      char *name;
+      char *args[ E_test_J_args ];
+    }cases[ E_test_J_cases ];
+    unsigned cases_n = 0;
+    while( fgets( line, sizeof(line), baseline ))
+    {   if( cases_n == E_test_J_cases )
+            return 2;
+        strcpy( cases[ cases_n ].line, line );
+        char *ratio_s;
+        char **args = cases[ cases_n ].args;
+        char *name = E_test_I_split( cases[ cases_n ].line, argv[1], &ratio_s, args );
+        if( !name )
+            continue;
+        if( !ratio_s )
+            return 2;
+        cases[ cases_n++ ].name = name;
+        char *end;
+        double min_ratio = strtod( ratio_s, &end );
+        char **base_args = 0;
+        if( *end == '@' )
+        {   unsigned i;
+            for( i = 0; i != cases_n - 1; i++ )
+                if( !strcmp( cases[i].name, end + 1 ))
+                    break;
+            if( i == cases_n - 1 )
+            {   fprintf( stderr, "%s: no earlier case %s\n", name, end + 1 );
+                return 2;
+            }
+            base_args = cases[i].args;
+        }
+        /* The case of a relative ratio is measured alternately with its base,
+         * so that both see the same state of the machine. */
+        double rate = 0, base = base_args ? 0 : calibration;
+        for( unsigned i = 0; i != E_test_J_runs; i++ )
+        {   double r = E_test_R_rate(args);
+            double b = base_args ? E_test_R_rate( base_args ) : base;
+            if( !r
+            || !b
+            )
+            {   rate = 0;
+                break;
+            }
+            if( r > rate )
+                rate = r;
+            if( b > base )
+                base = b;
+        }
+        double ratio = base ? rate / base : 0;
+        _Bool fail = ratio < min_ratio;
+        printf( "%-16s %10.2f MB/s  ratio %7.4f  minimum %7.4f%s%s\n", name, rate / 1e6, ratio, min_ratio, base_args ? end : "", fail ? "  FAILED" : "" );
+        if(fail)
+            ret = 1;
+    }
+    fclose(baseline);
+    return ret;
+}
+/******************************************************************************/
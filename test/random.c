@@ -0,0 +1,183 @@
+/******************************************************************************/
+/*
+ * Differential test of the bit pool in "random.c" against a reference model
+ * that keeps one bit per byte: refilling puts whole new bytes before the bits
+ * left from the previous refill; with no file descriptor the bytes are taken
+ * from the stream of "rand()" bits. Request sizes and reads are seeded random.
+ */
+#include <stdint.h>
+#include "../random.c"
+//==============================================================================
+#define E_test_J_source_bytes   ( 1 << 22 )
+#define E_test_J_steps          20000
+//==============================================================================
+const char *E_main_S_program = "test_random";
+static uint64_t E_test_S_seed;
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static unsigned char *E_test_S_source;
+static size_t E_test_S_source_i;
+static unsigned E_test_S_rand_bits;
+static uint64_t E_test_S_rand_d;
+static unsigned E_test_S_rand_n;
+static unsigned char *E_test_S_ref;
+static size_t E_test_S_ref_n;
+//==============================================================================
+static
+uint64_t
+E_test_R_seeded( void
+){  E_test_S_seed ^= E_test_S_seed << 13;
+    E_test_S_seed ^= E_test_S_seed >> 7;
+    E_test_S_seed ^= E_test_S_seed << 17;
+    return E_test_S_seed;
+}
+static
+void
+E_test_I_ref_prepare( size_t bits
+, _Bool from_rand
+){  if( bits <= E_test_S_ref_n )
+        return;
+    size_t new_bits = J_align_up( bits - E_test_S_ref_n, 8 );
+    E_test_S_ref = realloc( E_test_S_ref, new_bits + E_test_S_ref_n );
+    memmove( E_test_S_ref + new_bits, E_test_S_ref, E_test_S_ref_n );
+    for( size_t i = 0; i != new_bits; i += 8 )
+    {   unsigned d;
+        if( from_rand )
+        {   while( E_test_S_rand_n < 8 )
+            {   E_test_S_rand_d |= (uint64_t)( rand() & J_mask( E_test_S_rand_bits )) << E_test_S_rand_n;
+                E_test_S_rand_n += E_test_S_rand_bits;
+            }
+            d = E_test_S_rand_d & 0xff;
+            E_test_S_rand_d >>= 8;
+            E_test_S_rand_n -= 8;
+        }else
+            d = E_test_S_source[ E_test_S_source_i++ ];
+        for( size_t j = 0; j != 8; j++ )
+            E_test_S_ref[ i + j ] = ( d >> j ) & 1;
+    }
+    E_test_S_ref_n += new_bits;
+}
+static
+unsigned
+E_test_R_ref_bits( unsigned bits
+){  unsigned d = 0;
+    for( unsigned i = 0; i != bits; i++ )
+        d |= (unsigned)E_test_S_ref[i] << i;
+    memmove( E_test_S_ref, E_test_S_ref + bits, E_test_S_ref_n - bits );
+    E_test_S_ref_n -= bits;
+    return d;
+}
+/*
+ * Runs the same seeded sequence of requests on the pool and the model.
+ * With from_rand the pool has no file descriptor and both sides refill
+ * from rand() reseeded to the same value.
+ */
+static
+int
+E_test_I_run( uint64_t seed
+, _Bool from_rand
+){  for( unsigned side = 0; side != 2; side++ )
+    {   E_test_S_seed = seed;
+        srand( seed );
+        E_test_S_source_i = 0;
+        E_random_S_n_bits = E_random_S_i_bit = 0;
+        E_random_S_rand_n = E_test_S_rand_n = 0;
+        E_random_S_rand_d = E_test_S_rand_d = 0;
+        E_test_S_ref_n = 0;
+        if( !from_rand )
+            lseek( E_random_S_random_fd, 0, SEEK_SET );
+        uint64_t check = 0;
+        for( unsigned step = 0; step != E_test_J_steps; step++ )
+        {   uint64_t r = E_test_R_seeded();
+            size_t bits = r % 8 ? 1 + ( r >> 8 ) % 300 : 1 + ( r >> 8 ) % 20000;
+            if( side )
+                E_test_I_ref_prepare( bits, from_rand );
+            else if( E_random_I_prepare_data(bits))
+            {   fprintf( stderr, "step %u: prepare of %zu bits failed\n", step, bits );
+                return ~0;
+            }
+            size_t avail = side ? E_test_S_ref_n : E_random_S_n_bits - E_random_S_i_bit;
+            if( avail < bits )
+            {   fprintf( stderr, "step %u: %zu bits available, %zu requested\n", step, avail, bits );
+                return ~0;
+            }
+            size_t take = ( E_test_R_seeded() % ( bits + 1 ));
+            while(take)
+            {   unsigned n = 1 + E_test_R_seeded() % 32;
+                n = J_min( take, n );
+                unsigned d = side ? E_test_R_ref_bits(n) : E_random_R_bits(n);
+                check = ( check ^ d ^ n ) * 0x100000001b3ULL;
+                take -= n;
+            }
+        }
+        static uint64_t pool_check;
+        if( !side )
+            pool_check = check;
+        else if( check != pool_check )
+        {   fprintf( stderr, "%s: seed %llu: pool differs from the reference\n", from_rand ? "rand()" : "file", (unsigned long long)seed );
+            return ~0;
+        }
+    }
+    return 0;
+}
+/*
+ * Keyed mode: ChaCha20 blocks 0 and 1 of the zero key and item 0
+ * (RFC 8439, appendix A.1, test vectors 1 and 2).
+ */
+static
+int
+E_test_I_keyed( void
+){  static const unsigned char expected[128] =
+    { 0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90, 0x40, 0x5d, 0x6a, 0xe5, 0x53, 0x86, 0xbd, 0x28
+    , 0xbd, 0xd2, 0x19, 0xb8, 0xa0, 0x8d, 0xed, 0x1a, 0xa8, 0x36, 0xef, 0xcc, 0x8b, 0x77, 0x0d, 0xc7
+    , 0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37
+    , 0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86
+    , 0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d
+    , 0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3, 0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed
+    , 0x29, 0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0, 0x74, 0xd8, 0x39, 0xd5
+    , 0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb, 0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f
+    };
+    unsigned char key[32] = { 0 };
+    unsigned char out[128];
+    E_random_I_key(key);
+    for( unsigned i = 0; i != sizeof(out); i += 16 ) // Nierówne wczytania: przez bufor strumienia.
+    {   if( E_random_I_prepare_data( 16 * 8 ))
+            return ~0;
+        E_random_R_data( out + i, 16 );
+    }
+    E_random_S_keyed = false;
+    if( memcmp( out, expected, sizeof(out) ))
+    {   fprintf( stderr, "keyed: ChaCha20 stream differs from RFC 8439\n" );
+        return ~0;
+    }
+    return 0;
+}
+int
+main( void
+){  E_test_S_source = malloc( E_test_J_source_bytes );
+    E_test_S_seed = 88172645463325252ULL;
+    for( size_t i = 0; i != E_test_J_source_bytes; i++ )
+        E_test_S_source[i] = E_test_R_seeded();
+    char path[] = "/tmp/test_randomXXXXXX";
+    int fd = mkstemp(path);
+    if( !~fd
+    || write( fd, E_test_S_source, E_test_J_source_bytes ) != E_test_J_source_bytes
+    )
+        return 1;
+    unlink(path);
+    E_test_S_rand_bits = sizeof(unsigned) * 8 - __builtin_clz( RAND_MAX );
+    if( RAND_MAX ^ J_mask( E_test_S_rand_bits ))
+        E_test_S_rand_bits >>= 1;
+    int ret = 0;
+    if( E_test_I_keyed() )
+        ret = 1;
+    for( uint64_t seed = 1; seed != 9; seed++ )
+    {   E_random_S_random_fd = fd;
+        if( E_test_I_run( seed, false ))
+            ret = 1;
+        E_random_S_random_fd = ~0;
+        if( E_test_I_run( seed, true ))
+            ret = 1;
+    }
+    return ret;
+}
+/******************************************************************************/
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Concatenated shards must equal the single node output of the same key.
+ranpwd=$1
+key=000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f
+status=0
+for args in "-a 16 100" "-r 12 100" "-x 128b 100" "--base58 22 100" "-g 100" "-i 10.0.0.0/8 100" "--pattern XXXX-9999 100"
+do
+    single=$("$ranpwd" --key $key $args) || exit 1
+    shards=$(for i in 0 1 2 3 4 5 6; do "$ranpwd" --key $key --shard $i/7 $args || exit 1; done) || exit 1
+    if [ "$single" != "$shards" ]
+    then
+        echo "shards differ: $args"
+        status=1
+    fi
+done
+for shard in " 1/7" "+1/7" "-0/7" "1/ 7" "18446744073709551616/7" "1/18446744073709551616" "7/7"
+do
+    if "$ranpwd" --key $key --shard "$shard" -x 4 10 >/dev/null 2>&1
+    then
+        echo "invalid shard accepted: $shard"
+        status=1
+    fi
+done
+if "$ranpwd" -x 4 18446744073709551616 >/dev/null 2>&1
+then
+    echo "out of range count accepted"
+    status=1
+fi
+exit $status
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Neither the first nor the last IP octet may be 0 or 255; the first MAC octet
+# is unicast (bit 0 clear) and locally administered (bit 1 set).
+ranpwd=$1
+status=0
+for args in "-i 4 4000" "-i 2 4000" "-i 1 4000" "-i 10.0.0.0/24 254"
+do
+    out=$("$ranpwd" $args) || exit 1
+    if ! printf "%s\n" "$out" | awk -F. '$1 == 0 || $1 == 255 || $NF == 0 || $NF == 255 { exit 1 }'
+    then
+        echo "IP octet 0 or 255: $args"
+        status=1
+    fi
+done
+for args in "-m 6 4000" "-M 6 4000" "-m 1 4000" "-m 02:1a:2b 100"
+do
+    out=$("$ranpwd" $args) || exit 1
+    for octet in $(printf "%s\n" "$out" | cut -d: -f1 | sort -u)
+    do
+        if [ $(( 0x$octet & 3 )) -ne 2 ]
+        then
+            echo "MAC not unicast and local: $args: $octet"
+            status=1
+            break
+        fi
+    done
+done
+# Within a prefix the addresses are distinct, up to every one of them.
+for args in "-i 10.0.0.0/20 4094" "-m 02:1a:2b:3c 65536"
+do
+    n=$("$ranpwd" $args | sort -u | wc -l) || exit 1
+    if [ "$n" -ne "${args##* }" ]
+    then
+        echo "addresses not distinct: $args: $n"
+        status=1
+    fi
+done
+# More addresses than the prefix holds, or a malformed prefix, are refused.
+for args in "-i 10.0.0.0/31 3" "-i 10.0.0.0/24 255" "-i 10.+20.0.0/16 2" "-i 10.20. 2" "-i 10.20.0.0/+16 2" \
+    "-m 02:1a:2b:3c 65537" "-m 0x2:1a:2b 2" "-m 002:1a 2"
+do
+    if "$ranpwd" $args >/dev/null 2>&1
+    then
+        echo "accepted: $args"
+        status=1
+    fi
+done
+if "$ranpwd" -m " 2:1a:2b" 2 >/dev/null 2>&1
+then
+    echo "accepted a blank before a prefix"
+    status=1
+fi
+exit $status
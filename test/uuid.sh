@@ -0,0 +1,25 @@
+#!/bin/sh
+# UUID nibble 13 is the version (4 or 7), nibble 17 the RFC 9562 variant
+# (8, 9, a or b); version 7 UUIDs come out strictly increasing.
+ranpwd=$1
+status=0
+for args in "-g 2000" "-G 2000" "-g --uuid-version 7 2000" "-c -g 100"
+do
+    out=$("$ranpwd" $args) || { echo "failed: $args"; status=1; continue; }
+    version=4
+    case "$args" in *"version 7"*) version=7 ;; esac
+    if ! printf "%s\n" "$out" | tr -d '"' | tr A-F a-f | awk -v v=$version '
+        { h = $0; gsub( "-", "", h ) }
+        length( h ) != 32 || substr( h, 13, 1 ) != v || substr( h, 17, 1 ) !~ /^[89ab]$/ { exit 1 }'
+    then
+        echo "bad version or variant: $args"
+        status=1
+    fi
+done
+out=$("$ranpwd" -g --uuid-version 7 20000) || exit 1
+if [ "$(printf "%s\n" "$out" | LC_ALL=C sort -u)" != "$out" ]
+then
+    echo "version 7 not strictly increasing"
+    status=1
+fi
+exit $status